@@ -0,0 +1,169 @@
+#include <Engine/Render/Ressource/TextureMetadata.h>
+#include <Engine/Ressource/AssetPack.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	bool IsTextureMetadata(const std::filesystem::path& path)
+	{
+		// Only texture sidecars are cooked, other xml files (room presets...) are left alone
+		std::filesystem::path texturePath = path;
+		std::error_code error;
+		return path.extension() == ".xml" && std::filesystem::exists(texturePath.replace_extension(".png"), error);
+	}
+
+	bool ReadFile(const std::filesystem::path& path, std::vector<unsigned char>& content)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			return false;
+		}
+
+		content.resize((size_t)file.tellg());
+		file.seekg(0);
+		return (bool)file.read(reinterpret_cast<char*>(content.data()), content.size());
+	}
+
+	int CookMetadata(const std::filesystem::path& root, bool force)
+	{
+		int cooked = 0;
+		int skipped = 0;
+		int failed = 0;
+
+		std::error_code error;
+		for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(root, error))
+		{
+			const std::filesystem::path& xmlPath = entry.path();
+			if (!entry.is_regular_file() || !IsTextureMetadata(xmlPath))
+			{
+				continue;
+			}
+
+			std::filesystem::path cookedPath = xmlPath;
+			cookedPath.replace_extension(TextureMetadata::CookedExtension);
+
+			if (!force && std::filesystem::exists(cookedPath, error)
+				&& std::filesystem::last_write_time(cookedPath, error) >= std::filesystem::last_write_time(xmlPath, error))
+			{
+				++skipped;
+				continue;
+			}
+
+			AnimationDataMap animations;
+			StaticTileDataMap staticTiles;
+			if (!TextureMetadata::LoadFromXml(xmlPath, animations, staticTiles)
+				|| !TextureMetadata::SaveCooked(cookedPath, animations, staticTiles))
+			{
+				std::cerr << "AssetCooker: Failed to cook " << xmlPath << std::endl;
+				++failed;
+				continue;
+			}
+
+			std::cout << "Cooked " << cookedPath << " (" << animations.size() << " animations, " << staticTiles.size() << " tiles)" << std::endl;
+			++cooked;
+		}
+
+		std::cout << cooked << " cooked, " << skipped << " up to date, " << failed << " failed" << std::endl;
+		return failed;
+	}
+
+	// Packs every file of the folder. Texture xml are stored cooked, loose .tmd files are ignored
+	int BuildPack(const std::filesystem::path& root)
+	{
+		const std::filesystem::path packPath = root / AssetPack::DefaultFileName;
+
+		std::vector<AssetPack::SourceAsset> assets;
+		int failed = 0;
+
+		std::error_code error;
+		for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(root, error))
+		{
+			const std::filesystem::path& path = entry.path();
+			if (!entry.is_regular_file() || path.extension() == TextureMetadata::CookedExtension || std::filesystem::equivalent(path, packPath, error))
+			{
+				continue;
+			}
+
+			AssetPack::SourceAsset asset;
+			if (IsTextureMetadata(path))
+			{
+				AnimationDataMap animations;
+				StaticTileDataMap staticTiles;
+				if (!TextureMetadata::LoadFromXml(path, animations, staticTiles))
+				{
+					std::cerr << "AssetCooker: Failed to cook " << path << std::endl;
+					++failed;
+					continue;
+				}
+
+				std::filesystem::path cookedPath = path;
+				asset.RelativePath = cookedPath.replace_extension(TextureMetadata::CookedExtension).lexically_relative(root).generic_string();
+				TextureMetadata::Cook(animations, staticTiles, asset.Content);
+			}
+			else
+			{
+				asset.RelativePath = path.lexically_relative(root).generic_string();
+				if (!ReadFile(path, asset.Content))
+				{
+					std::cerr << "AssetCooker: Cannot read " << path << std::endl;
+					++failed;
+					continue;
+				}
+			}
+
+			assets.push_back(std::move(asset));
+		}
+
+		if (failed > 0 || !AssetPack::Write(packPath, assets))
+		{
+			std::cerr << "AssetCooker: Failed to write " << packPath << std::endl;
+			return failed + 1;
+		}
+
+		std::cout << "Packed " << assets.size() << " assets in " << packPath << std::endl;
+		return 0;
+	}
+}
+
+// Converts the .xml sidecar of every texture found in a folder into the binary .tmd read by TextureMgr.
+// With --pack, builds the Ressources.pak mounted at startup instead.
+// Usage: AssetCooker [RessourcesFolder] [--force] [--pack]
+int main(int argc, char** argv)
+{
+	std::filesystem::path root = "../Ressources";
+	bool force = false;
+	bool pack = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument = argv[i];
+		if (argument == "--force")
+		{
+			force = true;
+		}
+		else if (argument == "--pack")
+		{
+			pack = true;
+		}
+		else
+		{
+			root = argument;
+		}
+	}
+
+	std::error_code error;
+	if (!std::filesystem::is_directory(root, error))
+	{
+		std::cerr << "AssetCooker: " << root << " is not a folder" << std::endl;
+		return 1;
+	}
+
+	const int failed = pack ? BuildPack(root) : CookMetadata(root, force);
+	return failed == 0 ? 0 : 1;
+}
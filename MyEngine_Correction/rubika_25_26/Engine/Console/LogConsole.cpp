@@ -47,6 +47,8 @@ void Logger::Error(const std::string& message)
 
 void Logger::PushNewMessage(const sMessageInfo& message)
 {
+	// The texts are charged to the console too
+	MemoryTagScope scope(eMemoryTag::Console);
 	Messages.push_back(message);
 }
 
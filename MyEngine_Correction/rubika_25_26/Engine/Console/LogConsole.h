@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Engine/Debug/DebugMgr.h>
+#include <Engine/Memory/MemoryTracker.h>
 
 #include <string>
 #include <vector>
@@ -37,7 +38,7 @@ protected:
 	};
 
 	void PushNewMessage(const sMessageInfo& message);
-	std::vector<sMessageInfo> Messages;
+	std::vector<sMessageInfo, TaggedAllocator<sMessageInfo, eMemoryTag::Console>> Messages;
 
 	bool DisplayErrorMessage = true;
 	bool DisplayWarningMessage = true;
@@ -0,0 +1,184 @@
+#include "Archetype.h"
+
+#include <Engine/Memory/MemoryTracker.h>
+
+#include <algorithm>
+#include <assert.h>
+
+namespace
+{
+	size_t AlignUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+}
+
+Archetype::Archetype(std::vector<const ComponentTypeInfo*> componentTypes) : ComponentTypes(std::move(componentTypes)), Mask(0), ChunkCapacity(0), ChunkBytes(0), EntityCount(0)
+{
+	ColumnByTypeId.fill(InvalidColumn);
+	for (size_t column = 0; column < ComponentTypes.size(); ++column)
+	{
+		ColumnByTypeId[ComponentTypes[column]->Id] = column;
+		Mask |= ComponentTypes[column]->GetMask();
+	}
+
+	ComputeLayout();
+}
+
+Archetype::~Archetype()
+{
+	for (size_t row = 0; row < EntityCount; ++row)
+	{
+		for (size_t column = 0; column < ComponentTypes.size(); ++column)
+		{
+			ComponentTypes[column]->Destruct(GetComponent(column, row));
+		}
+	}
+
+	for (unsigned char* chunk : Chunks)
+	{
+		::operator delete(chunk, std::align_val_t(ChunkAlignment));
+	}
+
+	Chunks.clear();
+}
+
+const std::vector<const ComponentTypeInfo*>& Archetype::GetComponentTypes() const
+{
+	return ComponentTypes;
+}
+
+ComponentMask Archetype::GetMask() const
+{
+	return Mask;
+}
+
+size_t Archetype::FindColumn(size_t componentTypeId) const
+{
+	return ColumnByTypeId[componentTypeId];
+}
+
+size_t Archetype::GetEntityCount() const
+{
+	return EntityCount;
+}
+
+size_t Archetype::GetChunkCount() const
+{
+	return Chunks.size();
+}
+
+size_t Archetype::GetChunkEntityCount(size_t chunk) const
+{
+	return std::min(ChunkCapacity, EntityCount - chunk * ChunkCapacity);
+}
+
+void* Archetype::GetColumnData(size_t column, size_t chunk) const
+{
+	return Chunks[chunk] + ColumnOffsets[column];
+}
+
+void* Archetype::GetComponent(size_t column, size_t row) const
+{
+	return Chunks[row / ChunkCapacity] + ColumnOffsets[column] + (row % ChunkCapacity) * ComponentTypes[column]->Size;
+}
+
+Entity* Archetype::GetEntity(size_t row) const
+{
+	Entity** entities = reinterpret_cast<Entity**>(Chunks[row / ChunkCapacity]);
+	return entities[row % ChunkCapacity];
+}
+
+size_t Archetype::PushRow(Entity* entity)
+{
+	const size_t row = EntityCount;
+	if (row / ChunkCapacity >= Chunks.size())
+	{
+		MemoryTagScope scope(eMemoryTag::Components);
+		Chunks.push_back(static_cast<unsigned char*>(::operator new(ChunkBytes, std::align_val_t(ChunkAlignment))));
+	}
+
+	Entity** entities = reinterpret_cast<Entity**>(Chunks[row / ChunkCapacity]);
+	entities[row % ChunkCapacity] = entity;
+
+	++EntityCount;
+	return row;
+}
+
+Entity* Archetype::PopRow(size_t row)
+{
+	assert(row < EntityCount);
+
+	const size_t last = EntityCount - 1;
+	Entity* moved = nullptr;
+
+	if (row != last)
+	{
+		for (size_t column = 0; column < ComponentTypes.size(); ++column)
+		{
+			void* source = GetComponent(column, last);
+			ComponentTypes[column]->MoveConstruct(GetComponent(column, row), source);
+			ComponentTypes[column]->Destruct(source);
+		}
+
+		moved = GetEntity(last);
+		Entity** entities = reinterpret_cast<Entity**>(Chunks[row / ChunkCapacity]);
+		entities[row % ChunkCapacity] = moved;
+	}
+
+	--EntityCount;
+
+	// Release the trailing chunk as soon as it is empty
+	if (EntityCount % ChunkCapacity == 0 && Chunks.size() > EntityCount / ChunkCapacity)
+	{
+		::operator delete(Chunks.back(), std::align_val_t(ChunkAlignment));
+		Chunks.pop_back();
+	}
+
+	return moved;
+}
+
+void Archetype::Update(float fDeltaTime)
+{
+	for (size_t chunk = 0; chunk < Chunks.size(); ++chunk)
+	{
+		const size_t count = GetChunkEntityCount(chunk);
+		for (size_t column = 0; column < ComponentTypes.size(); ++column)
+		{
+			ComponentTypes[column]->UpdateRange(GetColumnData(column, chunk), count, fDeltaTime);
+		}
+	}
+}
+
+void Archetype::ComputeLayout()
+{
+	size_t bytesPerEntity = sizeof(Entity*);
+	for (const ComponentTypeInfo* info : ComponentTypes)
+	{
+		assert(info->Alignment <= ChunkAlignment);
+		bytesPerEntity += info->Size;
+	}
+
+	// Start from the ideal capacity and shrink it until every aligned column fits in the chunk
+	ChunkCapacity = std::max<size_t>(1, ChunkSizeInBytes / bytesPerEntity);
+	while (true)
+	{
+		ColumnOffsets.clear();
+
+		size_t offset = sizeof(Entity*) * ChunkCapacity;
+		for (const ComponentTypeInfo* info : ComponentTypes)
+		{
+			offset = AlignUp(offset, info->Alignment);
+			ColumnOffsets.push_back(offset);
+			offset += info->Size * ChunkCapacity;
+		}
+
+		if (offset <= ChunkSizeInBytes || ChunkCapacity == 1)
+		{
+			ChunkBytes = std::max(AlignUp(offset, ChunkAlignment), ChunkSizeInBytes);
+			break;
+		}
+
+		--ChunkCapacity;
+	}
+}
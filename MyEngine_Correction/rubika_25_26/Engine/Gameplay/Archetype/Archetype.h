@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Engine/Gameplay/Archetype/ComponentTypeInfo.h>
+
+#include <vector>
+#include <array>
+
+class Entity;
+
+// Stores every entity sharing the same set of components.
+// Entities are packed in fixed size chunks, each chunk holding one array per component type.
+// Rows are kept dense: removing an entity moves the last one in its place.
+class Archetype
+{
+public:
+	Archetype(std::vector<const ComponentTypeInfo*> componentTypes);
+	~Archetype();
+
+	Archetype(const Archetype&) = delete;
+	Archetype& operator=(const Archetype&) = delete;
+
+	const std::vector<const ComponentTypeInfo*>& GetComponentTypes() const;
+	ComponentMask GetMask() const;
+
+	size_t FindColumn(size_t componentTypeId) const;
+
+	size_t GetEntityCount() const;
+	size_t GetChunkCount() const;
+	size_t GetChunkEntityCount(size_t chunk) const;
+
+	void* GetColumnData(size_t column, size_t chunk) const;
+	void* GetComponent(size_t column, size_t row) const;
+	Entity* GetEntity(size_t row) const;
+
+	// Reserves a row at the end of the archetype. Components are left unconstructed
+	size_t PushRow(Entity* entity);
+
+	// Removes a row whose components are already destroyed by moving the last row in its place.
+	// Returns the entity now stored at this row, nullptr if the removed row was the last one
+	Entity* PopRow(size_t row);
+
+	void Update(float fDeltaTime);
+
+	static constexpr size_t InvalidColumn = (size_t)-1;
+	static constexpr size_t ChunkSizeInBytes = 16 * 1024;
+	static constexpr size_t ChunkAlignment = 64;
+
+private:
+	std::vector<const ComponentTypeInfo*> ComponentTypes;
+	ComponentMask Mask;
+
+	// Column of each component type id, InvalidColumn if the archetype doesn't have it
+	std::array<size_t, MaxComponentTypes> ColumnByTypeId;
+
+	std::vector<size_t> ColumnOffsets;
+	std::vector<unsigned char*> Chunks;
+
+	size_t ChunkCapacity;
+	size_t ChunkBytes;
+	size_t EntityCount;
+
+	void ComputeLayout();
+};
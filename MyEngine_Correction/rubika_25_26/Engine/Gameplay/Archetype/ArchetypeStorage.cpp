@@ -0,0 +1,123 @@
+#include "ArchetypeStorage.h"
+
+#include <Engine/Gameplay/Entity/Entity.h>
+#include <Engine/Memory/MemoryTracker.h>
+
+#include <algorithm>
+
+ArchetypeStorage::ArchetypeStorage()
+{}
+
+ArchetypeStorage::~ArchetypeStorage()
+{
+	for (Archetype* archetype : Archetypes)
+	{
+		delete archetype;
+	}
+
+	Archetypes.clear();
+	ArchetypesByMask.clear();
+}
+
+void ArchetypeStorage::Adopt(Entity& entity)
+{
+	if (entity.Storage == this)
+	{
+		return;
+	}
+
+	if (entity.EntityArchetype)
+	{
+		MoveRow(entity, FindOrCreateArchetype(entity.EntityArchetype->GetComponentTypes()));
+	}
+
+	entity.Storage = this;
+}
+
+void ArchetypeStorage::RemoveEntity(Entity& entity)
+{
+	Archetype* archetype = entity.EntityArchetype;
+	if (!archetype)
+	{
+		return;
+	}
+
+	const std::vector<const ComponentTypeInfo*>& componentTypes = archetype->GetComponentTypes();
+	for (size_t column = 0; column < componentTypes.size(); ++column)
+	{
+		componentTypes[column]->Destruct(archetype->GetComponent(column, entity.Row));
+	}
+
+	if (Entity* moved = archetype->PopRow(entity.Row))
+	{
+		moved->Row = entity.Row;
+	}
+
+	entity.EntityArchetype = nullptr;
+	entity.Row = 0;
+}
+
+void ArchetypeStorage::Update(float fDeltaTime)
+{
+	for (Archetype* archetype : Archetypes)
+	{
+		archetype->Update(fDeltaTime);
+	}
+}
+
+Archetype& ArchetypeStorage::FindOrCreateArchetype(std::vector<const ComponentTypeInfo*> componentTypes)
+{
+	ComponentMask mask = 0;
+	for (const ComponentTypeInfo* info : componentTypes)
+	{
+		mask |= info->GetMask();
+	}
+
+	const auto& it = ArchetypesByMask.find(mask);
+	if (it != ArchetypesByMask.end())
+	{
+		return *it->second;
+	}
+
+	std::sort(componentTypes.begin(), componentTypes.end(), [](const ComponentTypeInfo* a, const ComponentTypeInfo* b)
+	{
+		return a->Id < b->Id;
+	});
+
+	MemoryTagScope scope(eMemoryTag::Components);
+	Archetype* archetype = new Archetype(std::move(componentTypes));
+	Archetypes.push_back(archetype);
+	ArchetypesByMask.emplace(mask, archetype);
+	return *archetype;
+}
+
+size_t ArchetypeStorage::MoveRow(Entity& entity, Archetype& target)
+{
+	const size_t row = target.PushRow(&entity);
+
+	if (Archetype* source = entity.EntityArchetype)
+	{
+		const std::vector<const ComponentTypeInfo*>& componentTypes = source->GetComponentTypes();
+		for (size_t column = 0; column < componentTypes.size(); ++column)
+		{
+			void* component = source->GetComponent(column, entity.Row);
+
+			const size_t targetColumn = target.FindColumn(componentTypes[column]->Id);
+			if (targetColumn != Archetype::InvalidColumn)
+			{
+				componentTypes[column]->MoveConstruct(target.GetComponent(targetColumn, row), component);
+			}
+
+			componentTypes[column]->Destruct(component);
+		}
+
+		if (Entity* moved = source->PopRow(entity.Row))
+		{
+			moved->Row = entity.Row;
+		}
+	}
+
+	entity.EntityArchetype = &target;
+	entity.Row = row;
+	return row;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Engine/Gameplay/Archetype/Archetype.h>
+
+#include <vector>
+#include <unordered_map>
+
+class Entity;
+
+// Owns the archetypes and the components of the entities attached to it.
+// Adding a component moves the entity to another archetype: pointers on its components are invalidated.
+class ArchetypeStorage
+{
+public:
+	ArchetypeStorage();
+	~ArchetypeStorage();
+
+	ArchetypeStorage(const ArchetypeStorage&) = delete;
+	ArchetypeStorage& operator=(const ArchetypeStorage&) = delete;
+
+	template <typename C>
+	C* AddComponent(Entity& entity);
+
+	// Moves the entity and its components from its current storage to this one
+	void Adopt(Entity& entity);
+
+	// Destroys every component of the entity and detaches it from the storage
+	void RemoveEntity(Entity& entity);
+
+	void Update(float fDeltaTime);
+
+	template <typename C, typename F>
+	void ForEach(F&& function) const;
+
+	// Same as ForEach, with the chunks split between the job system threads: the function must only write the component
+	template <typename C, typename F>
+	void ParallelForEach(F&& function) const;
+
+private:
+	std::vector<Archetype*> Archetypes;
+	std::unordered_map<ComponentMask, Archetype*> ArchetypesByMask;
+
+	Archetype& FindOrCreateArchetype(std::vector<const ComponentTypeInfo*> componentTypes);
+	size_t MoveRow(Entity& entity, Archetype& target);
+};
+
+#include "ArchetypeStorage.hxx"
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "ArchetypeStorage.h"
+
+#include <Engine/Globals.h>
+#include <Engine/Gameplay/Entity/Entity.h>
+#include <Engine/Job/JobSystem.h>
+
+template <typename C>
+inline C* ArchetypeStorage::AddComponent(Entity& entity)
+{
+	const ComponentTypeInfo* info = ComponentTypeInfo::Get<C>();
+
+	std::vector<const ComponentTypeInfo*> componentTypes;
+	if (entity.EntityArchetype)
+	{
+		componentTypes = entity.EntityArchetype->GetComponentTypes();
+	}
+	componentTypes.push_back(info);
+
+	Archetype& target = FindOrCreateArchetype(std::move(componentTypes));
+	const size_t row = MoveRow(entity, target);
+
+	void* memory = target.GetComponent(target.FindColumn(info->Id), row);
+	return new (memory) C(entity);
+}
+
+template <typename C, typename F>
+inline void ArchetypeStorage::ForEach(F&& function) const
+{
+	const ComponentTypeInfo* info = ComponentTypeInfo::Get<C>();
+
+	for (Archetype* archetype : Archetypes)
+	{
+		if (!(archetype->GetMask() & info->GetMask()))
+		{
+			continue;
+		}
+
+		const size_t column = archetype->FindColumn(info->Id);
+
+		for (size_t chunk = 0; chunk < archetype->GetChunkCount(); ++chunk)
+		{
+			C* components = static_cast<C*>(archetype->GetColumnData(column, chunk));
+			const size_t count = archetype->GetChunkEntityCount(chunk);
+			for (size_t i = 0; i < count; ++i)
+			{
+				function(components[i]);
+			}
+		}
+	}
+}
+
+template <typename C, typename F>
+inline void ArchetypeStorage::ParallelForEach(F&& function) const
+{
+	const ComponentTypeInfo* info = ComponentTypeInfo::Get<C>();
+	JobSystem& jobSystem = *gData.JobSystem;
+
+	for (Archetype* archetype : Archetypes)
+	{
+		if (!(archetype->GetMask() & info->GetMask()))
+		{
+			continue;
+		}
+
+		const size_t column = archetype->FindColumn(info->Id);
+
+		const auto& processChunks = [archetype, column, &function](size_t first, size_t last)
+		{
+			for (size_t chunk = first; chunk < last; ++chunk)
+			{
+				C* components = static_cast<C*>(archetype->GetColumnData(column, chunk));
+				const size_t count = archetype->GetChunkEntityCount(chunk);
+				for (size_t i = 0; i < count; ++i)
+				{
+					function(components[i]);
+				}
+			}
+		};
+
+		if (jobSystem.IsParallelForEachEnabled() && archetype->GetChunkCount() > 1)
+		{
+			jobSystem.ParallelFor(archetype->GetChunkCount(), 1, processChunks);
+		}
+		else
+		{
+			processChunks(0, archetype->GetChunkCount());
+		}
+	}
+}
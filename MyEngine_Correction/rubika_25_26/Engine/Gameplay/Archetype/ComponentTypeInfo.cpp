@@ -0,0 +1,18 @@
+#include "ComponentTypeInfo.h"
+
+#include <cstdlib>
+#include <iostream>
+
+size_t ComponentTypeInfo::NextId()
+{
+	static size_t nextId = 0;
+
+	// Not an assert: past the limit the masks would shift out of range and silently collide in release
+	if (nextId >= MaxComponentTypes)
+	{
+		std::cerr << "Too many component types (" << MaxComponentTypes << " max), enlarge ComponentMask" << std::endl;
+		std::abort();
+	}
+
+	return nextId++;
+}
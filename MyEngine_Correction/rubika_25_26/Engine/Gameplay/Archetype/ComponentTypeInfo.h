@@ -0,0 +1,86 @@
+#pragma once
+
+#include <Engine/Gameplay/Component/IComponent.h>
+
+#include <type_traits>
+#include <cstdint>
+#include <utility>
+#include <new>
+
+// One bit per component type, indexed by ComponentTypeInfo::Id
+using ComponentMask = uint64_t;
+constexpr size_t MaxComponentTypes = sizeof(ComponentMask) * 8;
+
+// Type erased description of a component type, used by the archetype storage
+// to move, destroy and update components without knowing their type
+struct ComponentTypeInfo
+{
+	// Index assigned to the type the first time it is used, in [0, MaxComponentTypes[
+	size_t Id;
+	size_t Size;
+	size_t Alignment;
+
+	void (*MoveConstruct)(void* destination, void* source);
+	void (*Destruct)(void* component);
+	IComponent* (*AsComponent)(void* component);
+	void (*UpdateRange)(void* first, size_t count, float fDeltaTime);
+
+	ComponentMask GetMask() const;
+
+	template <typename C>
+	static const ComponentTypeInfo* Get();
+
+	template <typename C>
+	static size_t GetId();
+
+private:
+	static size_t NextId();
+};
+
+template <typename C>
+inline const ComponentTypeInfo* ComponentTypeInfo::Get()
+{
+	static_assert(std::is_base_of<IComponent, C>(), "Components must inherit from IComponent");
+	static_assert(std::is_move_constructible<C>(), "Components are moved when their entity changes archetype");
+
+	static const ComponentTypeInfo info
+	{
+		NextId(),
+		sizeof(C),
+		alignof(C),
+		[](void* destination, void* source)
+		{
+			new (destination) C(std::move(*static_cast<C*>(source)));
+		},
+		[](void* component)
+		{
+			static_cast<C*>(component)->~C();
+		},
+		[](void* component) -> IComponent*
+		{
+			return static_cast<C*>(component);
+		},
+		[](void* first, size_t count, float fDeltaTime)
+		{
+			// A column only holds C so the call can be resolved statically
+			C* components = static_cast<C*>(first);
+			for (size_t i = 0; i < count; ++i)
+			{
+				components[i].C::Update(fDeltaTime);
+			}
+		}
+	};
+
+	return &info;
+}
+
+template <typename C>
+inline size_t ComponentTypeInfo::GetId()
+{
+	return Get<C>()->Id;
+}
+
+inline ComponentMask ComponentTypeInfo::GetMask() const
+{
+	return ComponentMask(1) << Id;
+}
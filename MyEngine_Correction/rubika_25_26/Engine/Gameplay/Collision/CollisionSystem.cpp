@@ -0,0 +1,245 @@
+#include "CollisionSystem.h"
+
+#include <Engine/Globals.h>
+#include <Engine/Simd.h>
+#include <Engine/Memory/MemoryTracker.h>
+#include <Engine/Gameplay/Archetype/ArchetypeStorage.h>
+#include <Engine/Gameplay/Entity/Entity.h>
+#include <Engine/Gameplay/Component/Collider/Collider.h>
+#include <Engine/Gameplay/Component/Transform/Transform.h>
+
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Time.hpp>
+
+#ifdef _USE_IMGUI
+#include <Imgui/imgui.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+
+CollisionSystem::CollisionSystem() : UseSimd(true), LastUpdateTimeInMs(0.f)
+{}
+
+CollisionSystem::~CollisionSystem()
+{}
+
+void CollisionSystem::Init()
+{
+	gData.DebugMgr->RegisterDebugableWindow("CollisionSystem", this);
+}
+
+void CollisionSystem::Shut()
+{
+	gData.DebugMgr->UnregisterDebugableWindow("CollisionSystem");
+}
+
+void CollisionSystem::Update(const ArchetypeStorage& storage)
+{
+	MemoryTagScope scope(eMemoryTag::Collision);
+	sf::Clock clock;
+
+	Gather(storage);
+	Broadphase();
+	Narrowphase();
+
+	LastUpdateTimeInMs = clock.getElapsedTime().asSeconds() * 1000.f;
+
+	Dispatch();
+}
+
+void CollisionSystem::DrawDebug()
+{
+#ifdef _USE_IMGUI
+	ImGui::Text("Colliders: %u", (unsigned int)Owners.size());
+	ImGui::Text("Broadphase pairs: %u", (unsigned int)Candidates.size());
+	ImGui::Text("Contacts: %u", (unsigned int)Contacts.size());
+	ImGui::Text("Detection time: %.3f ms", LastUpdateTimeInMs);
+
+#ifdef USE_SSE2
+	ImGui::Checkbox("SSE2 narrowphase", &UseSimd);
+#else
+	ImGui::Text("SSE2: not available");
+#endif
+#endif
+}
+
+void CollisionSystem::Gather(const ArchetypeStorage& storage)
+{
+	CentersX.clear();
+	CentersY.clear();
+	HalfExtentsX.clear();
+	HalfExtentsY.clear();
+	Radii.clear();
+	MinsX.clear();
+	MaxsX.clear();
+	MinsY.clear();
+	MaxsY.clear();
+	Layers.clear();
+	Masks.clear();
+	Owners.clear();
+
+	storage.ForEach<Collider>([this](Collider& collider)
+	{
+		Entity& owner = collider.GetEntity();
+
+		const Transform* transform = owner.GetComponent<Transform>();
+		if (!transform)
+		{
+			return;
+		}
+
+		const sf::Vector2f center = transform->GetWorldPosition() + collider.Offset;
+		const sf::Vector2f extents = collider.HalfExtents + sf::Vector2f(collider.Radius, collider.Radius);
+
+		CentersX.push_back(center.x);
+		CentersY.push_back(center.y);
+		HalfExtentsX.push_back(collider.HalfExtents.x);
+		HalfExtentsY.push_back(collider.HalfExtents.y);
+		Radii.push_back(collider.Radius);
+		MinsX.push_back(center.x - extents.x);
+		MaxsX.push_back(center.x + extents.x);
+		MinsY.push_back(center.y - extents.y);
+		MaxsY.push_back(center.y + extents.y);
+		Layers.push_back(collider.Layer);
+		Masks.push_back(collider.Mask);
+		Owners.push_back(&owner);
+	});
+}
+
+void CollisionSystem::Broadphase()
+{
+	Candidates.clear();
+
+	SortedByMinX.resize(Owners.size());
+	for (uint32_t i = 0; i < SortedByMinX.size(); ++i)
+	{
+		SortedByMinX[i] = i;
+	}
+
+	std::sort(SortedByMinX.begin(), SortedByMinX.end(), [this](uint32_t a, uint32_t b)
+	{
+		return MinsX[a] < MinsX[b];
+	});
+
+	// Only the colliders starting before the end of the current one can overlap it on X
+	for (size_t i = 0; i < SortedByMinX.size(); ++i)
+	{
+		const uint32_t a = SortedByMinX[i];
+		const float maxX = MaxsX[a];
+
+		for (size_t j = i + 1; j < SortedByMinX.size(); ++j)
+		{
+			const uint32_t b = SortedByMinX[j];
+			if (MinsX[b] > maxX)
+			{
+				break;
+			}
+
+			if (MinsY[b] > MaxsY[a] || MinsY[a] > MaxsY[b])
+			{
+				continue;
+			}
+
+			if (!(Layers[a] & Masks[b]) || !(Layers[b] & Masks[a]))
+			{
+				continue;
+			}
+
+			Candidates.push_back(Pair{ a, b });
+		}
+	}
+}
+
+void CollisionSystem::Narrowphase()
+{
+	Contacts.clear();
+
+#ifdef USE_SSE2
+	if (UseSimd)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+		size_t i = 0;
+		for (; i + 4 <= Candidates.size(); i += 4)
+		{
+			const Pair* pairs = &Candidates[i];
+
+			const auto gatherA = [pairs](const std::vector<float>& values)
+			{
+				return _mm_setr_ps(values[pairs[0].A], values[pairs[1].A], values[pairs[2].A], values[pairs[3].A]);
+			};
+			const auto gatherB = [pairs](const std::vector<float>& values)
+			{
+				return _mm_setr_ps(values[pairs[0].B], values[pairs[1].B], values[pairs[2].B], values[pairs[3].B]);
+			};
+
+			// Distance between the centers, minus the extents of both boxes, must be within the sum of the radii
+			const __m128 distanceX = _mm_and_ps(_mm_sub_ps(gatherA(CentersX), gatherB(CentersX)), absMask);
+			const __m128 distanceY = _mm_and_ps(_mm_sub_ps(gatherA(CentersY), gatherB(CentersY)), absMask);
+			const __m128 gapX = _mm_max_ps(_mm_sub_ps(distanceX, _mm_add_ps(gatherA(HalfExtentsX), gatherB(HalfExtentsX))), zero);
+			const __m128 gapY = _mm_max_ps(_mm_sub_ps(distanceY, _mm_add_ps(gatherA(HalfExtentsY), gatherB(HalfExtentsY))), zero);
+			const __m128 radius = _mm_add_ps(gatherA(Radii), gatherB(Radii));
+
+			const __m128 gapSquared = _mm_add_ps(_mm_mul_ps(gapX, gapX), _mm_mul_ps(gapY, gapY));
+			const int touching = _mm_movemask_ps(_mm_cmple_ps(gapSquared, _mm_mul_ps(radius, radius)));
+
+			for (int lane = 0; lane < 4; ++lane)
+			{
+				if (touching & (1 << lane))
+				{
+					Contacts.push_back(pairs[lane]);
+				}
+			}
+		}
+
+		NarrowphaseScalar(i);
+		return;
+	}
+#endif
+
+	NarrowphaseScalar(0);
+}
+
+void CollisionSystem::NarrowphaseScalar(size_t first)
+{
+	for (size_t i = first; i < Candidates.size(); ++i)
+	{
+		if (Touch(Candidates[i].A, Candidates[i].B))
+		{
+			Contacts.push_back(Candidates[i]);
+		}
+	}
+}
+
+void CollisionSystem::Dispatch()
+{
+	for (const Pair& contact : Contacts)
+	{
+		Entity& a = *Owners[contact.A];
+		Entity& b = *Owners[contact.B];
+
+		// The gathered arrays only hold copies of the shapes, the callbacks live in the components
+		const Collider* colliderA = a.GetComponent<Collider>();
+		if (colliderA && colliderA->Callback)
+		{
+			colliderA->Callback(b);
+		}
+
+		const Collider* colliderB = b.GetComponent<Collider>();
+		if (colliderB && colliderB->Callback)
+		{
+			colliderB->Callback(a);
+		}
+	}
+}
+
+bool CollisionSystem::Touch(uint32_t a, uint32_t b) const
+{
+	const float gapX = std::max(std::abs(CentersX[a] - CentersX[b]) - (HalfExtentsX[a] + HalfExtentsX[b]), 0.f);
+	const float gapY = std::max(std::abs(CentersY[a] - CentersY[b]) - (HalfExtentsY[a] + HalfExtentsY[b]), 0.f);
+	const float radius = Radii[a] + Radii[b];
+
+	return gapX * gapX + gapY * gapY <= radius * radius;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Engine/Debug/DebugMgr.h>
+
+#include <vector>
+#include <cstdint>
+
+class Entity;
+class ArchetypeStorage;
+
+// Finds the touching colliders of a storage once per frame.
+// The broadphase sorts the collider bounds along X and sweeps them to keep the overlapping pairs,
+// the narrowphase tests those pairs 4 at a time with SSE2 when available.
+// Callbacks are only called once every contact of the frame is known. They must not add components,
+// which would move the colliders left to dispatch: entities are destroyed through GameMgr::DestroyEntity.
+class CollisionSystem final : public IDebugable
+{
+public:
+	CollisionSystem();
+	~CollisionSystem();
+
+	void Init();
+	void Shut();
+
+	void Update(const ArchetypeStorage& storage);
+
+	virtual void DrawDebug() override;
+
+private:
+	struct Pair
+	{
+		uint32_t A;
+		uint32_t B;
+	};
+
+	// Every shape is a box rounded by a radius: a box has no radius, a circle has no extents
+	std::vector<float> CentersX;
+	std::vector<float> CentersY;
+	std::vector<float> HalfExtentsX;
+	std::vector<float> HalfExtentsY;
+	std::vector<float> Radii;
+	std::vector<float> MinsX;
+	std::vector<float> MaxsX;
+	std::vector<float> MinsY;
+	std::vector<float> MaxsY;
+	std::vector<uint32_t> Layers;
+	std::vector<uint32_t> Masks;
+	std::vector<Entity*> Owners;
+
+	std::vector<uint32_t> SortedByMinX;
+	std::vector<Pair> Candidates;
+	std::vector<Pair> Contacts;
+
+	bool UseSimd;
+	float LastUpdateTimeInMs;
+
+	void Gather(const ArchetypeStorage& storage);
+	void Broadphase();
+	void Narrowphase();
+	void NarrowphaseScalar(size_t first);
+	void Dispatch();
+
+	bool Touch(uint32_t a, uint32_t b) const;
+};
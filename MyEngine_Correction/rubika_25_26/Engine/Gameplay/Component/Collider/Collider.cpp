@@ -0,0 +1,84 @@
+#include "Collider.h"
+
+#include <Engine/Gameplay/Entity/Entity.h>
+
+Collider::Collider(Entity& entity) : IComponent(entity)
+{
+	Shape = eColliderShape::Box;
+	HalfExtents = sf::Vector2f(0.5f, 0.5f);
+	Radius = 0.f;
+	Offset = sf::Vector2f();
+
+	Layer = 1;
+	Mask = 0xFFFFFFFF;
+}
+
+Collider::Collider(Collider&& other) : IComponent(other), Shape(other.Shape), HalfExtents(other.HalfExtents), Radius(other.Radius), Offset(other.Offset),
+	Layer(other.Layer), Mask(other.Mask), Callback(std::move(other.Callback))
+{}
+
+Collider::~Collider()
+{}
+
+void Collider::SetBox(sf::Vector2f halfExtents)
+{
+	Shape = eColliderShape::Box;
+	HalfExtents = halfExtents;
+	Radius = 0.f;
+}
+
+void Collider::SetCircle(float radius)
+{
+	Shape = eColliderShape::Circle;
+	HalfExtents = sf::Vector2f();
+	Radius = radius;
+}
+
+eColliderShape Collider::GetShape() const
+{
+	return Shape;
+}
+
+void Collider::SetOffset(sf::Vector2f offset)
+{
+	Offset = offset;
+}
+
+sf::Vector2f Collider::GetOffset() const
+{
+	return Offset;
+}
+
+void Collider::SetLayer(uint32_t layer)
+{
+	Layer = layer;
+}
+
+uint32_t Collider::GetLayer() const
+{
+	return Layer;
+}
+
+void Collider::SetMask(uint32_t mask)
+{
+	Mask = mask;
+}
+
+uint32_t Collider::GetMask() const
+{
+	return Mask;
+}
+
+void Collider::SetCallback(CollisionCallback callback)
+{
+	Callback = std::move(callback);
+}
+
+void Collider::Start()
+{}
+
+void Collider::Update(float fDeltaTime)
+{}
+
+void Collider::Destroy()
+{}
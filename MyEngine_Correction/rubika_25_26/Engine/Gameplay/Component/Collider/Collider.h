@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Engine/Gameplay/Component/IComponent.h>
+
+#include <SFML/System/Vector2.hpp>
+
+#include <functional>
+#include <cstdint>
+
+enum class eColliderShape
+{
+	Box,
+	Circle,
+};
+
+// Axis aligned box or circle centered on the entity world position, plus an offset.
+// The scale and rotation of the transform are ignored.
+// Two colliders touch if the layer of each one is in the mask of the other.
+class Collider : public IComponent
+{
+public:
+	using CollisionCallback = std::function<void(Entity& other)>;
+
+	Collider(Entity& entity);
+	Collider(Collider&& other);
+	~Collider();
+
+	void SetBox(sf::Vector2f halfExtents);
+	void SetCircle(float radius);
+	eColliderShape GetShape() const;
+
+	void SetOffset(sf::Vector2f offset);
+	sf::Vector2f GetOffset() const;
+
+	void SetLayer(uint32_t layer);
+	uint32_t GetLayer() const;
+
+	void SetMask(uint32_t mask);
+	uint32_t GetMask() const;
+
+	// Called once per frame for every collider touching this one, after the collision pass
+	void SetCallback(CollisionCallback callback);
+
+	virtual void Start() override;
+	virtual void Update(float fDeltaTime) override;
+	virtual void Destroy() override;
+
+	friend class CollisionSystem;
+
+private:
+	eColliderShape Shape;
+	sf::Vector2f HalfExtents;
+	float Radius;
+	sf::Vector2f Offset;
+
+	uint32_t Layer;
+	uint32_t Mask;
+
+	CollisionCallback Callback;
+};
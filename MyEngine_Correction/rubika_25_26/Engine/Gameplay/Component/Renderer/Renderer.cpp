@@ -1,16 +1,39 @@
 #include "Renderer.h"
 
+#include <Engine/Globals.h>
 #include <Engine/Render/Drawable/IDrawable.h>
+#include <Engine/Render/Batch/SpriteBatcher.h>
 #include <Engine/Gameplay/Component/Transform/Transform.h>
 #include <Engine/Gameplay/Entity/Entity.h>
+#include <Engine/Gameplay/GameMgr.h>
+#include <Engine/Gameplay/Spatial/SpatialHashGrid.h>
 
-Renderer::Renderer(Entity& entity): IComponent(entity)
+#include <algorithm>
+
+Renderer::Renderer(Entity& entity): IComponent(entity), CullingProxy(SpatialHashGrid::InvalidProxy), CullingBounds(), CullingBoundsDirty(false)
 {}
 
+Renderer::Renderer(Renderer&& other): IComponent(other), Drawables(std::move(other.Drawables)), CullingProxy(other.CullingProxy),
+	CullingBounds(other.CullingBounds), CullingBoundsDirty(other.CullingBoundsDirty)
+{
+	other.Drawables.clear();
+	other.CullingProxy = SpatialHashGrid::InvalidProxy;
+}
+
 Renderer::~Renderer()
 {
+	if (CullingProxy != SpatialHashGrid::InvalidProxy)
+	{
+		gData.GameMgr->GetRenderGrid().Remove(CullingProxy);
+	}
+
 	for (const DrawableInfo& info : Drawables)
 	{
+		if (info.Drawable->IsStatic())
+		{
+			gData.SpriteBatcher->UnregisterStatic(info.Drawable);
+		}
+
 		delete info.Drawable;
 	}
 
@@ -19,43 +42,80 @@ Renderer::~Renderer()
 
 void Renderer::Start()
 {
-	TransformComponent = GetEntity().GetComponent<Transform>();
+	const Transform* TransformComponent = GetEntity().GetComponent<Transform>();
 
-	for (const DrawableInfo& info : Drawables)
+	for (DrawableInfo& info : Drawables)
 	{
-		if (info.HasRelativeTransform)
-		{
-			info.Drawable->SetWorldTransform(TransformComponent->GetMatrix() * info.RelativeTransform);
-		}
-		else
+		RefreshWorldTransform(info, *TransformComponent);
+		info.Drawable->Start();
+
+		if (info.Drawable->IsStatic())
 		{
-			info.Drawable->SetWorldTransform(TransformComponent->GetMatrix());
+			gData.SpriteBatcher->RegisterStatic(info.Drawable);
 		}
-
-		info.Drawable->Start();
 	}
+
+	RefreshCullingBounds();
 }
 
 void Renderer::Update(float fDeltaTime)
 {
-	for (const DrawableInfo& info : Drawables)
+	for (DrawableInfo& info : Drawables)
 	{
 		if (info.Drawable->IsVisible())
 		{
-			if (info.HasRelativeTransform)
-			{
-				info.Drawable->SetWorldTransform(TransformComponent->GetMatrix() * info.RelativeTransform);
-			}
-			else
-			{
-				info.Drawable->SetWorldTransform(TransformComponent->GetMatrix());
-			}
-
 			info.Drawable->Update(fDeltaTime);
 		}
 	}
 }
 
+void Renderer::SyncWithTransform()
+{
+	// Components move when their entity changes archetype, so the transform is not cached
+	const Transform* TransformComponent = GetEntity().GetComponent<Transform>();
+	const uint32_t transformVersion = TransformComponent->GetVersion();
+
+	for (DrawableInfo& info : Drawables)
+	{
+		// Static drawables are baked by the batcher and don't follow the entity.
+		// Entities that didn't move keep the world transform computed before
+		if (info.Drawable->IsVisible() && !info.Drawable->IsStatic() && info.TransformVersion != transformVersion)
+		{
+			RefreshWorldTransform(info, *TransformComponent);
+		}
+	}
+
+	// Moves, animations and texture loads all change the bounds of the drawables
+	for (const DrawableInfo& info : Drawables)
+	{
+		if (!info.Drawable->IsStatic() && info.BoundsVersion != info.Drawable->GetBoundsVersion())
+		{
+			CullingBoundsDirty = MergeCullingBounds();
+			break;
+		}
+	}
+}
+
+void Renderer::SyncCullingProxy()
+{
+	if (!CullingBoundsDirty)
+	{
+		return;
+	}
+
+	CullingBoundsDirty = false;
+
+	SpatialHashGrid& grid = gData.GameMgr->GetRenderGrid();
+	if (CullingProxy == SpatialHashGrid::InvalidProxy)
+	{
+		CullingProxy = grid.Insert(GetEntity(), CullingBounds);
+	}
+	else
+	{
+		grid.Move(CullingProxy, CullingBounds);
+	}
+}
+
 void Renderer::Destroy()
 {}
 
@@ -67,6 +127,8 @@ void Renderer::SetDrawableRelativePosition(const IDrawable* drawable, const sf::
 		{
 			info.RelativePosition = position;
 			info.ComputeTransform();
+			info.TransformVersion = 0;
+			RefreshStaticDrawable(info);
 			return;
 		}
 	}
@@ -80,6 +142,8 @@ void Renderer::SetDrawableRelativeRotation(const IDrawable* drawable, float rota
 		{
 			info.RelativeRotation = rotation;
 			info.ComputeTransform();
+			info.TransformVersion = 0;
+			RefreshStaticDrawable(info);
 			return;
 		}
 	}
@@ -93,22 +157,108 @@ void Renderer::SetDrawableRelativeScale(const IDrawable* drawable, const sf::Vec
 		{
 			info.RelativeScale = scale;
 			info.ComputeTransform();
+			info.TransformVersion = 0;
+			RefreshStaticDrawable(info);
 			return;
 		}
 	}
 }
 
-void Renderer::Draw(sf::RenderWindow& window) const
+void Renderer::Submit(SpriteBatcher& batcher, const sf::FloatRect& view) const
 {
 	for (const DrawableInfo& info : Drawables)
 	{
-		if (info.Drawable->IsVisible())
+		if (info.Drawable->IsStatic() || !info.Drawable->GetWorldBounds().findIntersection(view))
 		{
-			info.Drawable->Draw(window);
+			continue;
 		}
+
+		batcher.Submit(*info.Drawable);
+	}
+}
+
+void Renderer::RefreshWorldTransform(DrawableInfo& info, const Transform& transform) const
+{
+	info.TransformVersion = transform.GetVersion();
+
+	if (info.HasRelativeTransform)
+	{
+		info.Drawable->SetWorldTransform(transform.GetMatrix() * info.RelativeTransform);
+	}
+	else
+	{
+		info.Drawable->SetWorldTransform(transform.GetMatrix());
 	}
 }
 
+void Renderer::RefreshStaticDrawable(DrawableInfo& info) const
+{
+	// Static drawables are not refreshed by SyncWithTransform
+	if (!info.Drawable->IsStatic())
+	{
+		return;
+	}
+
+	if (const Transform* TransformComponent = GetEntity().GetComponent<Transform>())
+	{
+		RefreshWorldTransform(info, *TransformComponent);
+	}
+}
+
+void Renderer::RefreshCullingBounds()
+{
+	CullingBoundsDirty = MergeCullingBounds();
+	SyncCullingProxy();
+}
+
+bool Renderer::MergeCullingBounds()
+{
+	bool hasBounds = false;
+	sf::Vector2f min;
+	sf::Vector2f max;
+
+	for (DrawableInfo& info : Drawables)
+	{
+		// Static drawables are baked by the batcher and never culled
+		if (info.Drawable->IsStatic())
+		{
+			continue;
+		}
+
+		info.BoundsVersion = info.Drawable->GetBoundsVersion();
+
+		// Hidden drawables don't follow the entity, their bounds are stale.
+		// Showing them again bumps their version, which merges them back
+		if (!info.Drawable->IsVisible())
+		{
+			continue;
+		}
+
+		const sf::FloatRect& bounds = info.Drawable->GetWorldBounds();
+
+		if (!hasBounds)
+		{
+			min = bounds.position;
+			max = bounds.position + bounds.size;
+			hasBounds = true;
+			continue;
+		}
+
+		min.x = std::min(min.x, bounds.position.x);
+		min.y = std::min(min.y, bounds.position.y);
+		max.x = std::max(max.x, bounds.position.x + bounds.size.x);
+		max.y = std::max(max.y, bounds.position.y + bounds.size.y);
+	}
+
+	if (!hasBounds)
+	{
+		return false;
+	}
+
+	CullingBounds = sf::FloatRect(min, max - min);
+	return true;
+}
+
 Renderer::DrawableInfo::DrawableInfo()
 {
 	FriendlyName = "";
@@ -116,16 +266,15 @@ Renderer::DrawableInfo::DrawableInfo()
 	RelativePosition = sf::Vector2f();
 	RelativeRotation = 0.f;
 	RelativeScale = sf::Vector2f(1.f, 1.f);
-	RelativeTransform = sf::Transform::Identity;
+	RelativeTransform = Affine2D::Identity;
 	HasRelativeTransform = false;
+	TransformVersion = 0;
+	BoundsVersion = 0;
 }
 
 void Renderer::DrawableInfo::ComputeTransform()
 {
-	RelativeTransform = sf::Transform::Identity;
-	RelativeTransform.translate(RelativePosition);
-	RelativeTransform.rotate(sf::degrees(RelativeRotation));
-	RelativeTransform.scale(RelativeScale);
+	RelativeTransform = Affine2D::Compose(RelativePosition, RelativeRotation, RelativeScale);
 
-	HasRelativeTransform = RelativeTransform != sf::Transform::Identity;
+	HasRelativeTransform = RelativeTransform != Affine2D::Identity;
 }
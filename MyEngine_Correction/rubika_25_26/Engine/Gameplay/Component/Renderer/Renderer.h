@@ -1,15 +1,18 @@
 #pragma once
 
 #include <Engine/Gameplay/Component/IComponent.h>
+#include <Engine/Math/Affine2D.h>
 
 #include <SFML/System/Vector2.hpp>
-#include <SFML/Graphics/Transform.hpp>
+#include <SFML/Graphics/Rect.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
 
 #include <vector>
 #include <string>
+#include <cstdint>
 
 class IDrawable;
+class SpriteBatcher;
 class Transform;
 
 
@@ -17,12 +20,19 @@ class Renderer : public IComponent
 {
 public:
 	Renderer(Entity& entity);
+	Renderer(Renderer&& other);
 	~Renderer();
 
 	virtual void Start() override;
 
 	virtual void Update(float fDeltaTime) override;
 
+	// Moves the drawables to the world transform of the entity and merges their bounds.
+	// Called by the GameMgr once every transform of the frame is final. Any thread: only writes the renderer and its drawables
+	void SyncWithTransform();
+	// Main thread, after SyncWithTransform: moves the entity in the render grid if its bounds changed
+	void SyncCullingProxy();
+
 	virtual void Destroy() override;
 
 	template <class D>
@@ -35,7 +45,8 @@ public:
 	void SetDrawableRelativeRotation(const IDrawable* drawable, float rotation);
 	void SetDrawableRelativeScale(const IDrawable* drawable, const sf::Vector2f& scale);
 
-	void Draw(sf::RenderWindow& window) const;
+	// Only submits the drawables overlapping the view
+	void Submit(SpriteBatcher& batcher, const sf::FloatRect& view) const;
 
 protected:
 
@@ -48,14 +59,30 @@ protected:
 		sf::Vector2f RelativePosition;
 		float RelativeRotation;
 		sf::Vector2f RelativeScale;
-		sf::Transform RelativeTransform;
+		Affine2D RelativeTransform;
 		bool HasRelativeTransform;
 
+		// Version of the entity transform the world transform was computed from, 0 when it must be recomputed
+		uint32_t TransformVersion;
+
+		// Version of the drawable bounds merged in the culling bounds, 0 when never merged
+		uint32_t BoundsVersion;
+
 		void ComputeTransform();
 	};
 
 	std::vector<DrawableInfo> Drawables;
-	Transform* TransformComponent;
+
+	// Bounds of the dynamic drawables in the render grid of the GameMgr, used to cull the whole entity
+	uint32_t CullingProxy;
+	sf::FloatRect CullingBounds;
+	// Merged by SyncWithTransform, not in the grid yet
+	bool CullingBoundsDirty;
+
+	void RefreshWorldTransform(DrawableInfo& info, const Transform& transform) const;
+	void RefreshStaticDrawable(DrawableInfo& info) const;
+	void RefreshCullingBounds();
+	bool MergeCullingBounds();
 };
 
 #include "Renderer.hxx"
\ No newline at end of file
@@ -23,7 +23,7 @@ inline D* Renderer::AddNewDrawable(const std::string& drawableFriendlyName)
 	info.Drawable = drawable;
 	info.FriendlyName = drawableFriendlyName;
 	info.HasRelativeTransform = false;
-	info.RelativeTransform = sf::Transform::Identity;
+	info.RelativeTransform = Affine2D::Identity;
 
 	return drawable;
 }
@@ -55,8 +55,7 @@ inline D* Renderer::AddNewDrawable(const std::string& drawableFriendlyName, sf::
 	info.FriendlyName = drawableFriendlyName;
 	info.HasRelativeTransform = true;
 
-	info.RelativeTransform = sf::Transform::Identity;
-	info.RelativeTransform.translate(relativePos).rotate(sf::degrees(relativeAngle)).scale(relativeScale);
+	info.RelativeTransform = Affine2D::Compose(relativePos, relativeAngle, relativeScale);
 
 	return drawable;
 }
\ No newline at end of file
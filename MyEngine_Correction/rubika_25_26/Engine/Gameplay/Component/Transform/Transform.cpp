@@ -1,34 +1,141 @@
 #include "Transform.h"
 
+#include <Engine/Globals.h>
+#include <Engine/Gameplay/GameMgr.h>
 #include <Engine/Gameplay/Entity/Entity.h>
+#include <Engine/Gameplay/Component/Transform/TransformHierarchy.h>
+#include <Engine/Gameplay/Spatial/SpatialHashGrid.h>
 
 Transform::Transform(Entity& entity) : IComponent(entity)
 {
-	WorldPosition = sf::Vector2f();
+	LocalPosition = sf::Vector2f();
 	Rotation = 0.f;
 	Scale = sf::Vector2f(1.f, 1.f);
+	Version = 0;
+	HierarchyNode = TransformHierarchy::InvalidId;
+	SpatialProxy = SpatialHashGrid::InvalidProxy;
 
 	UpdateMatrix();
 }
 
+Transform::Transform(Transform&& other) : IComponent(other), Matrix(other.Matrix), LocalMatrix(other.LocalMatrix), LocalPosition(other.LocalPosition),
+	Rotation(other.Rotation), Scale(other.Scale), Version(other.Version), HierarchyNode(other.HierarchyNode),
+	SpatialProxy(other.SpatialProxy), SpatialHalfExtents(other.SpatialHalfExtents)
+{
+	// The node and the proxy follow the entity, not the memory of the component
+	other.HierarchyNode = TransformHierarchy::InvalidId;
+	other.SpatialProxy = SpatialHashGrid::InvalidProxy;
+}
 
 Transform::~Transform()
-{}
+{
+	if (HierarchyNode != TransformHierarchy::InvalidId)
+	{
+		gData.GameMgr->GetHierarchy().DestroyNode(HierarchyNode);
+	}
+
+	DisableSpatialQueries();
+}
 
-const sf::Transform& Transform::GetMatrix() const
+const Affine2D& Transform::GetMatrix() const
 {
 	return Matrix;
 }
 
+const Affine2D& Transform::GetLocalMatrix() const
+{
+	return LocalMatrix;
+}
+
+uint32_t Transform::GetVersion() const
+{
+	return Version;
+}
+
+void Transform::EnableSpatialQueries(sf::Vector2f halfExtents)
+{
+	SpatialHalfExtents = halfExtents;
+
+	SpatialHashGrid& grid = gData.GameMgr->GetSpatialGrid();
+	if (SpatialProxy == SpatialHashGrid::InvalidProxy)
+	{
+		SpatialProxy = grid.Insert(GetEntity(), GetSpatialBounds());
+	}
+	else
+	{
+		grid.Move(SpatialProxy, GetSpatialBounds());
+	}
+}
+
+void Transform::DisableSpatialQueries()
+{
+	if (SpatialProxy == SpatialHashGrid::InvalidProxy)
+	{
+		return;
+	}
+
+	gData.GameMgr->GetSpatialGrid().Remove(SpatialProxy);
+	SpatialProxy = SpatialHashGrid::InvalidProxy;
+}
+
+bool Transform::SetParent(Entity* parent)
+{
+	TransformHierarchy& hierarchy = gData.GameMgr->GetHierarchy();
+
+	if (!parent)
+	{
+		if (HierarchyNode != TransformHierarchy::InvalidId)
+		{
+			hierarchy.SetParent(HierarchyNode, TransformHierarchy::InvalidId);
+		}
+		return true;
+	}
+
+	Transform* parentTransform = parent->GetComponent<Transform>();
+	if (!parentTransform)
+	{
+		return false;
+	}
+
+	const uint32_t parentNode = parentTransform->GetOrCreateNode();
+	return hierarchy.SetParent(GetOrCreateNode(), parentNode);
+}
+
+Entity* Transform::GetParent() const
+{
+	if (HierarchyNode == TransformHierarchy::InvalidId)
+	{
+		return nullptr;
+	}
+
+	return gData.GameMgr->GetHierarchy().GetParent(HierarchyNode);
+}
+
 void Transform::SetWorldPosition(sf::Vector2f newPosition)
 {
-	WorldPosition = newPosition;
-	UpdateMatrix();
+	if (Entity* parent = GetParent())
+	{
+		const Affine2D& parentMatrix = parent->GetComponent<Transform>()->GetMatrix();
+		newPosition = parentMatrix.GetInverse().TransformPoint(newPosition);
+	}
+
+	SetLocalPosition(newPosition);
 }
 
 sf::Vector2f Transform::GetWorldPosition() const
 {
-	return WorldPosition;
+	return Matrix.GetTranslation();
+}
+
+void Transform::SetLocalPosition(sf::Vector2f newPosition)
+{
+	LocalPosition = newPosition;
+	UpdateMatrix();
+}
+
+sf::Vector2f Transform::GetLocalPosition() const
+{
+	return LocalPosition;
 }
 
 void Transform::SetRotation(float newRotation)
@@ -64,8 +171,50 @@ void Transform::Destroy()
 
 void Transform::UpdateMatrix()
 {
-	Matrix = sf::Transform::Identity;
-	Matrix.translate(WorldPosition);
-	Matrix.rotate(sf::degrees(Rotation));
-	Matrix.scale(Scale);
+	LocalMatrix = Affine2D::Compose(LocalPosition, Rotation, Scale);
+
+	if (HierarchyNode != TransformHierarchy::InvalidId)
+	{
+		TransformHierarchy& hierarchy = gData.GameMgr->GetHierarchy();
+		hierarchy.SetLocal(HierarchyNode, LocalMatrix);
+
+		// Children wait for the hierarchy update, roots move right away
+		if (hierarchy.GetParent(HierarchyNode))
+		{
+			return;
+		}
+	}
+
+	SetWorldMatrix(LocalMatrix);
+}
+
+void Transform::SetWorldMatrix(const Affine2D& matrix)
+{
+	Matrix = matrix;
+
+	// 0 is kept for "never computed"
+	if (++Version == 0)
+	{
+		Version = 1;
+	}
+
+	if (SpatialProxy != SpatialHashGrid::InvalidProxy)
+	{
+		gData.GameMgr->GetSpatialGrid().Move(SpatialProxy, GetSpatialBounds());
+	}
+}
+
+uint32_t Transform::GetOrCreateNode()
+{
+	if (HierarchyNode == TransformHierarchy::InvalidId)
+	{
+		HierarchyNode = gData.GameMgr->GetHierarchy().CreateNode(GetEntity(), LocalMatrix);
+	}
+
+	return HierarchyNode;
+}
+
+sf::FloatRect Transform::GetSpatialBounds() const
+{
+	return sf::FloatRect(Matrix.GetTranslation() - SpatialHalfExtents, SpatialHalfExtents * 2.f);
 }
@@ -2,12 +2,20 @@
 
 #include <Engine/Gameplay/Component/IComponent.h>
 
-#include <SFML/Graphics/Transform.hpp>
+#include <Engine/Math/Affine2D.h>
 
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Graphics/Rect.hpp>
+
+#include <cstdint>
+
+// Position, rotation and scale are local: relative to the parent transform if there is one, world otherwise.
+// Children follow their parent once the GameMgr propagated the hierarchy, after the components and after the collisions.
 class Transform : public IComponent
 {
 public:
 	Transform(Entity& entity);
+	Transform(Transform&& other);
 	~Transform();
 
 	struct DecomposedData
@@ -17,11 +25,27 @@ public:
 		sf::Vector2f Scale;
 	};
 
-	const sf::Transform& GetMatrix() const;
+	// World matrix
+	const Affine2D& GetMatrix() const;
+	const Affine2D& GetLocalMatrix() const;
+
+	// Bumped every time the matrix changes, so users can skip the work when it didn't
+	uint32_t GetVersion() const;
+
+	// Tracks the entity in the GameMgr spatial grid, as a box of the given half size around its world position
+	void EnableSpatialQueries(sf::Vector2f halfExtents);
+	void DisableSpatialQueries();
+
+	// The parent entity must have a Transform. Fails if it is a descendant of this entity
+	bool SetParent(Entity* parent);
+	Entity* GetParent() const;
 
 	void SetWorldPosition(sf::Vector2f newPosition);
 	sf::Vector2f GetWorldPosition() const;
 
+	void SetLocalPosition(sf::Vector2f newPosition);
+	sf::Vector2f GetLocalPosition() const;
+
 	void SetRotation(float newRotation);
 	float GetRotation() const;
 
@@ -32,12 +56,26 @@ public:
 	virtual void Update(float fDeltaTime) override;
 	virtual void Destroy() override;
 
+	friend class TransformHierarchy;
+
 private:
-	sf::Transform Matrix;
+	Affine2D Matrix;
+	Affine2D LocalMatrix;
 
-	sf::Vector2f WorldPosition;
+	sf::Vector2f LocalPosition;
 	float Rotation;
 	sf::Vector2f Scale;
 
+	uint32_t Version;
+
+	// Only transforms with a parent or children have a node in the hierarchy
+	uint32_t HierarchyNode;
+
+	uint32_t SpatialProxy;
+	sf::Vector2f SpatialHalfExtents;
+
 	void UpdateMatrix();
+	void SetWorldMatrix(const Affine2D& matrix);
+	uint32_t GetOrCreateNode();
+	sf::FloatRect GetSpatialBounds() const;
 };
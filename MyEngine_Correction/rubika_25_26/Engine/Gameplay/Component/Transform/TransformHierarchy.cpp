@@ -0,0 +1,202 @@
+#include "TransformHierarchy.h"
+
+#include <Engine/Gameplay/Entity/Entity.h>
+#include <Engine/Gameplay/Component/Transform/Transform.h>
+
+#include <algorithm>
+#include <assert.h>
+
+TransformHierarchy::TransformHierarchy() : OrderDirty(false)
+{}
+
+TransformHierarchy::~TransformHierarchy()
+{}
+
+uint32_t TransformHierarchy::CreateNode(Entity& owner, const Affine2D& local)
+{
+	uint32_t id;
+	if (FreeIds.size() != 0)
+	{
+		id = FreeIds.back();
+		FreeIds.pop_back();
+	}
+	else
+	{
+		id = (uint32_t)IndexById.size();
+		IndexById.push_back(InvalidId);
+	}
+
+	// A new root can go at the end without breaking the depth order
+	IndexById[id] = (uint32_t)Nodes.size();
+
+	Node& node = Nodes.emplace_back();
+	node.Owner = &owner;
+	node.Id = id;
+	node.ParentId = InvalidId;
+	node.ParentIndex = InvalidId;
+	node.Depth = 0;
+	node.Local = local;
+	node.World = local;
+	node.Dirty = false;
+
+	return id;
+}
+
+void TransformHierarchy::DestroyNode(uint32_t id)
+{
+	for (Node& node : Nodes)
+	{
+		if (node.ParentId == id)
+		{
+			node.ParentId = InvalidId;
+			node.Dirty = true;
+		}
+	}
+
+	const uint32_t index = IndexById[id];
+	assert(index != InvalidId);
+
+	if (index != Nodes.size() - 1)
+	{
+		Nodes[index] = Nodes.back();
+		IndexById[Nodes[index].Id] = index;
+	}
+	Nodes.pop_back();
+
+	IndexById[id] = InvalidId;
+	FreeIds.push_back(id);
+
+	OrderDirty = true;
+}
+
+bool TransformHierarchy::SetParent(uint32_t id, uint32_t parentId)
+{
+	for (uint32_t ancestor = parentId; ancestor != InvalidId; ancestor = GetNode(ancestor).ParentId)
+	{
+		if (ancestor == id)
+		{
+			return false;
+		}
+	}
+
+	Node& node = GetNode(id);
+	node.ParentId = parentId;
+	node.Dirty = true;
+
+	OrderDirty = true;
+	return true;
+}
+
+Entity* TransformHierarchy::GetParent(uint32_t id) const
+{
+	const Node& node = GetNode(id);
+	if (node.ParentId == InvalidId)
+	{
+		return nullptr;
+	}
+
+	return GetNode(node.ParentId).Owner;
+}
+
+void TransformHierarchy::SetLocal(uint32_t id, const Affine2D& local)
+{
+	Node& node = GetNode(id);
+	node.Local = local;
+	node.Dirty = true;
+}
+
+const Affine2D& TransformHierarchy::GetWorld(uint32_t id) const
+{
+	return GetNode(id).World;
+}
+
+void TransformHierarchy::Update()
+{
+	if (OrderDirty)
+	{
+		SortByDepth();
+	}
+
+	for (size_t i = 0; i < Nodes.size(); ++i)
+	{
+		Node& node = Nodes[i];
+		if (node.ParentIndex == InvalidId)
+		{
+			if (node.Dirty)
+			{
+				node.World = node.Local;
+			}
+			continue;
+		}
+
+		// The parent was handled earlier in this pass
+		const Node& parent = Nodes[node.ParentIndex];
+		if (parent.Dirty || node.Dirty)
+		{
+			node.World = parent.World * node.Local;
+			node.Dirty = true;
+		}
+	}
+
+	for (Node& node : Nodes)
+	{
+		if (!node.Dirty)
+		{
+			continue;
+		}
+
+		if (Transform* transform = node.Owner->GetComponent<Transform>())
+		{
+			transform->SetWorldMatrix(node.World);
+		}
+
+		node.Dirty = false;
+	}
+}
+
+size_t TransformHierarchy::GetNodeCount() const
+{
+	return Nodes.size();
+}
+
+TransformHierarchy::Node& TransformHierarchy::GetNode(uint32_t id)
+{
+	assert(id < IndexById.size() && IndexById[id] != InvalidId);
+	return Nodes[IndexById[id]];
+}
+
+const TransformHierarchy::Node& TransformHierarchy::GetNode(uint32_t id) const
+{
+	assert(id < IndexById.size() && IndexById[id] != InvalidId);
+	return Nodes[IndexById[id]];
+}
+
+void TransformHierarchy::SortByDepth()
+{
+	for (Node& node : Nodes)
+	{
+		node.Depth = 0;
+		for (uint32_t ancestor = node.ParentId; ancestor != InvalidId; ancestor = GetNode(ancestor).ParentId)
+		{
+			++node.Depth;
+		}
+	}
+
+	// Stable so siblings keep their order and the pass stays deterministic
+	std::stable_sort(Nodes.begin(), Nodes.end(), [](const Node& a, const Node& b)
+	{
+		return a.Depth < b.Depth;
+	});
+
+	for (uint32_t i = 0; i < Nodes.size(); ++i)
+	{
+		IndexById[Nodes[i].Id] = i;
+	}
+
+	for (Node& node : Nodes)
+	{
+		node.ParentIndex = node.ParentId != InvalidId ? IndexById[node.ParentId] : InvalidId;
+	}
+
+	OrderDirty = false;
+}
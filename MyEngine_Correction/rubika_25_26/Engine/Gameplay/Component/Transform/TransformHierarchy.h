@@ -0,0 +1,71 @@
+#pragma once
+
+#include <Engine/Math/Affine2D.h>
+
+#include <vector>
+#include <cstdint>
+
+class Entity;
+
+// Parent/child links between transforms.
+// Nodes are kept in a flat array sorted by depth, so a parent is always before its children
+// and every world matrix is computed in a single pass without recursion.
+// Nodes are referenced by ids which stay valid when the array is sorted again.
+class TransformHierarchy
+{
+public:
+	TransformHierarchy();
+	~TransformHierarchy();
+
+	TransformHierarchy(const TransformHierarchy&) = delete;
+	TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+
+	static constexpr uint32_t InvalidId = 0xFFFFFFFF;
+
+	uint32_t CreateNode(Entity& owner, const Affine2D& local);
+
+	// Children of the node become roots, keeping their local transform
+	void DestroyNode(uint32_t id);
+
+	// Fails if the parent is a descendant of the node
+	bool SetParent(uint32_t id, uint32_t parentId);
+	Entity* GetParent(uint32_t id) const;
+
+	void SetLocal(uint32_t id, const Affine2D& local);
+	const Affine2D& GetWorld(uint32_t id) const;
+
+	// Recomputes the world matrix of the moved nodes and their descendants,
+	// then writes it back in their Transform component
+	void Update();
+
+	size_t GetNodeCount() const;
+
+private:
+	struct Node
+	{
+		Entity* Owner;
+		uint32_t Id;
+		uint32_t ParentId;
+
+		// Resolved when sorting, only valid while the order is up to date
+		uint32_t ParentIndex;
+		uint32_t Depth;
+
+		Affine2D Local;
+		Affine2D World;
+		bool Dirty;
+	};
+
+	std::vector<Node> Nodes;
+
+	// Position of each id in Nodes, InvalidId for free ids
+	std::vector<uint32_t> IndexById;
+	std::vector<uint32_t> FreeIds;
+
+	bool OrderDirty;
+
+	Node& GetNode(uint32_t id);
+	const Node& GetNode(uint32_t id) const;
+
+	void SortByDepth();
+};
@@ -1,54 +1,31 @@
 #include "Entity.h"
 
+#include <Engine/Globals.h>
+#include <Engine/Gameplay/GameMgr.h>
 #include <Engine/Gameplay/Component/IComponent.h>
 #include <Engine/Gameplay/Component/Transform/Transform.h>
-#include <SFML/Graphics/RenderWindow.hpp>
-#include <Engine/Gameplay/Component/Renderer/Renderer.h>
 
-Entity::Entity(std::string friendlyName): FriendlyName(friendlyName)
+Entity::Entity(std::string friendlyName): FriendlyName(friendlyName), Storage(&gData.GameMgr->GetPendingStorage()), EntityArchetype(nullptr), Row(0),
+	GameIndex(NotInGame), SpawnSerial(0), SpawnQueued(false), DestroyQueued(false)
 {}
 
 Entity::~Entity()
 {
-	for (const IComponent* component : Components)
-	{
-		delete component;
-	}
-
-	Components.clear();
+	Storage->RemoveEntity(*this);
 }
 
 void Entity::Start()
 {
-	for (IComponent* c : Components)
+	ForEachComponent([](IComponent* c)
 	{
 		c->Start();
-	}
-}
-
-void Entity::Update(float fDeltaTime)
-{
-	for (IComponent* c : Components)
-	{
-		c->Update(fDeltaTime);
-	}
+	});
 }
 
 void Entity::Destroy()
 {
-	for (IComponent* c : Components)
+	ForEachComponent([](IComponent* c)
 	{
 		c->Destroy();
-	}
-}
-
-void Entity::Draw(sf::RenderWindow& window) const
-{
-	Renderer* rendererComp = GetComponent<Renderer>();
-	if (!rendererComp)
-	{
-		return;
-	}
-
-	rendererComp->Draw(window);
+	});
 }
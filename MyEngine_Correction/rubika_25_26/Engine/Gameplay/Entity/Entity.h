@@ -1,39 +1,64 @@
 #pragma once
 
 #include <Engine/Gameplay/Component/Transform/Transform.h>
+#include <Engine/Memory/ObjectPool.h>
 
 #include <vector>
+#include <cstdint>
 #include <string>
 
-namespace sf
-{
-	class RenderWindow;
-}
+class Archetype;
+class ArchetypeStorage;
 
-class Entity
+// Entities are pooled: a destroyed entity leaves its memory to the next one created
+class Entity : public PooledObject<Entity>
 {
 public:
 	Entity(std::string friendlyName = "");
 	virtual ~Entity();
 
-	virtual void Start();
+	Entity(const Entity&) = delete;
+	Entity& operator=(const Entity&) = delete;
 
-	virtual void Update(float fDeltaTime);
+	// Components are updated by their archetype, not through their entity
+	virtual void Start();
 
 	virtual void Destroy();
 
+	// Adding a component moves the entity to another archetype:
+	// previously returned component pointers must be fetched again
 	template <typename C>
 	C* AddComponent();
 
 	template <typename C>
 	C* GetComponent() const;
 
-	void Draw(sf::RenderWindow& window) const;
+	// True if the entity owns every listed component type
+	template <typename... C>
+	bool HasComponents() const;
+
+	friend class ArchetypeStorage;
+	friend class GameMgr;
 
 protected:
 
-	std::vector<IComponent*> Components;
 	std::string FriendlyName;
+
+private:
+	ArchetypeStorage* Storage;
+	Archetype* EntityArchetype;
+	size_t Row;
+
+	// Position in the entities of the GameMgr, NotInGame until the spawn is flushed
+	static constexpr size_t NotInGame = (size_t)-1;
+	size_t GameIndex;
+	// Increases with every spawn, keeps the draw order stable. 0 until spawned
+	uint64_t SpawnSerial;
+	bool SpawnQueued;
+	bool DestroyQueued;
+
+	template <typename F>
+	void ForEachComponent(F&& function) const;
 };
 
-#include "Entity.hxx"
\ No newline at end of file
+#include "Entity.hxx"
@@ -2,21 +2,32 @@
 
 #include "Entity.h"
 
+#include <Engine/Gameplay/Archetype/ArchetypeStorage.h>
+
 template <typename C>
 inline C* Entity::GetComponent() const
 {
 	if (!std::is_base_of<IComponent, C>())
 		return nullptr;
 
-	for (auto& component : Components)
-	{
-		if (dynamic_cast<C*>(component))
-		{
-			return reinterpret_cast<C*>(component);
-		}
-	}
+	if (!EntityArchetype)
+		return nullptr;
 
-	return nullptr;
+	const size_t column = EntityArchetype->FindColumn(ComponentTypeInfo::GetId<C>());
+	if (column == Archetype::InvalidColumn)
+		return nullptr;
+
+	return static_cast<C*>(EntityArchetype->GetComponent(column, Row));
+}
+
+template <typename... C>
+inline bool Entity::HasComponents() const
+{
+	if (!EntityArchetype)
+		return false;
+
+	const ComponentMask required = (ComponentTypeInfo::Get<C>()->GetMask() | ...);
+	return (EntityArchetype->GetMask() & required) == required;
 }
 
 template<typename C>
@@ -28,7 +39,18 @@ inline C* Entity::AddComponent()
 	if (GetComponent<C>())
 		return nullptr;
 
-	C* component = new C(*this);
-	Components.push_back(component);
-	return component;
-}
\ No newline at end of file
+	return Storage->AddComponent<C>(*this);
+}
+
+template <typename F>
+inline void Entity::ForEachComponent(F&& function) const
+{
+	if (!EntityArchetype)
+		return;
+
+	const std::vector<const ComponentTypeInfo*>& componentTypes = EntityArchetype->GetComponentTypes();
+	for (size_t column = 0; column < componentTypes.size(); ++column)
+	{
+		function(componentTypes[column]->AsComponent(EntityArchetype->GetComponent(column, Row)));
+	}
+}
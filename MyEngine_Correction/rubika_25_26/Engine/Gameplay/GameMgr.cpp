@@ -1,8 +1,37 @@
 #include "GameMgr.h"
 
+#include <Engine/Globals.h>
+#include <Engine/Profiler.h>
+#include <Engine/Memory/MemoryTracker.h>
 #include <Engine/Gameplay/Entity/Entity.h>
+#include <Engine/Gameplay/Component/Renderer/Renderer.h>
+#include <Engine/Render/Batch/SpriteBatcher.h>
+#include <Engine/Render/Animation/AnimationSystem.h>
+#include <Engine/Gameplay/Collision/CollisionSystem.h>
 
-GameMgr::GameMgr()
+#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/View.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Box around the view, rotated or not
+	sf::FloatRect GetViewBounds(const sf::View& view)
+	{
+		const float radians = view.getRotation().asRadians();
+		const float cosine = std::abs(std::cos(radians));
+		const float sine = std::abs(std::sin(radians));
+
+		const sf::Vector2f halfSize = view.getSize() / 2.f;
+		const sf::Vector2f halfExtents(halfSize.x * cosine + halfSize.y * sine, halfSize.x * sine + halfSize.y * cosine);
+
+		return sf::FloatRect(view.getCenter() - halfExtents, halfExtents * 2.f);
+	}
+}
+
+GameMgr::GameMgr() : RenderGrid(256.f), NextSpawnSerial(1)
 {}
 
 GameMgr::~GameMgr()
@@ -13,32 +42,212 @@ GameMgr::~GameMgr()
 		delete e;
 	}
 
+	// Never started: nothing to destroy in their components
+	for (Entity* e : SpawnCommands)
+	{
+		delete e;
+	}
+
+	// Entities still in the game were deleted above
+	for (Entity* e : DestroyCommands)
+	{
+		if (e->GameIndex == Entity::NotInGame)
+		{
+			delete e;
+		}
+	}
+
 	Entities.clear();
+	SpawnCommands.clear();
+	DestroyCommands.clear();
 }
 
 void GameMgr::Update(float deltaTime)
 {
-	for (Entity* e : Entities)
+	// Before the renderers, so they see the bounds of the new frames
+	PROFILER_EVENT_BEGIN(PROFILER_COLOR_PINK, "Animations");
+	gData.AnimationSystem->Update(deltaTime);
+	PROFILER_EVENT_END();
+
+	PROFILER_EVENT_BEGIN(PROFILER_COLOR_RED, "Components");
+	Storage.Update(deltaTime);
+	PROFILER_EVENT_END();
+
+	// Children follow the parents moved by the components, so the colliders see them where they are drawn
+	PROFILER_EVENT_BEGIN(PROFILER_COLOR_YELLOW, "Hierarchy");
+	Hierarchy.Update();
+	PROFILER_EVENT_END();
+
+	PROFILER_EVENT_BEGIN(PROFILER_COLOR_ORANGE, "Collisions");
+	gData.CollisionSystem->Update(Storage);
+	PROFILER_EVENT_END();
+
+	// Again for the parents moved by the collision callbacks, then the drawables catch up with every move of the frame
+	PROFILER_EVENT_BEGIN(PROFILER_COLOR_YELLOW, "Hierarchy");
+	Hierarchy.Update();
+	PROFILER_EVENT_END();
+
+	// The transforms and bounds of every drawable are computed in parallel, the render grid is only written on this thread
+	PROFILER_EVENT_BEGIN(PROFILER_COLOR_GREEN, "Renderers");
+	Storage.ParallelForEach<Renderer>([](Renderer& renderer)
 	{
-		e->Update(deltaTime);
-	}
+		renderer.SyncWithTransform();
+	});
+	Storage.ForEach<Renderer>([](Renderer& renderer)
+	{
+		renderer.SyncCullingProxy();
+	});
+	PROFILER_EVENT_END();
+
+	// Sync point: nothing iterates the entities anymore this frame
+	PROFILER_EVENT_BEGIN(PROFILER_COLOR_WHITE, "Flush commands");
+	FlushCommands();
+	PROFILER_EVENT_END();
 }
 
 void GameMgr::Draw(sf::RenderWindow& window)
 {
-	for (Entity* e : Entities)
+	MemoryTagScope scope(eMemoryTag::Rendering);
+
+	SpriteBatcher& batcher = *gData.SpriteBatcher;
+	batcher.Begin();
+
+	const sf::FloatRect view = GetViewBounds(window.getView());
+
+	VisibleEntities.clear();
+	RenderGrid.QueryAabb(view, VisibleEntities);
+
+	// The grid returns the entities in cell order, which changes when they move: sort them in spawn order,
+	// so overlapping drawables of a layer keep the same order every frame and newer entities draw over older ones
+	std::sort(VisibleEntities.begin(), VisibleEntities.end(), [](const Entity* a, const Entity* b)
+	{
+		return a->SpawnSerial < b->SpawnSerial;
+	});
+
+	for (const Entity* entity : VisibleEntities)
 	{
-		e->Draw(window);
+		if (const Renderer* renderer = entity->GetComponent<Renderer>())
+		{
+			renderer->Submit(batcher, view);
+		}
 	}
+
+	batcher.Flush(window);
+}
+
+Entity* GameMgr::CreateEntity(const std::string& friendlyName)
+{
+	MemoryTagScope scope(eMemoryTag::Entities);
+	return new Entity(friendlyName);
 }
 
 void GameMgr::AddEntity(Entity* entity)
 {
-	if (!entity)
+	if (!entity || entity->SpawnQueued || entity->DestroyQueued || entity->GameIndex != Entity::NotInGame)
 	{
 		return;
 	}
 
-	Entities.push_back(entity);
-	entity->Start();
+	entity->SpawnQueued = true;
+	SpawnCommands.push_back(entity);
+}
+
+void GameMgr::DestroyEntity(Entity* entity)
+{
+	if (!entity || entity->DestroyQueued)
+	{
+		return;
+	}
+
+	// Spawned and destroyed in the same frame: it never enters the game
+	if (entity->SpawnQueued)
+	{
+		const auto& it = std::find(SpawnCommands.begin(), SpawnCommands.end(), entity);
+		*it = SpawnCommands.back();
+		SpawnCommands.pop_back();
+		entity->SpawnQueued = false;
+	}
+
+	entity->DestroyQueued = true;
+	DestroyCommands.push_back(entity);
+}
+
+void GameMgr::FlushCommands()
+{
+	// Destroy callbacks may queue more commands: handle the ones known now, the others wait for the next flush
+	std::vector<Entity*> destroyed;
+	destroyed.swap(DestroyCommands);
+
+	for (Entity* entity : destroyed)
+	{
+		if (entity->GameIndex != Entity::NotInGame)
+		{
+			entity->Destroy();
+		}
+	}
+
+	for (Entity* entity : destroyed)
+	{
+		// The last entity takes the place of the removed one
+		const size_t index = entity->GameIndex;
+		if (index != Entity::NotInGame)
+		{
+			Entities[index] = Entities.back();
+			Entities[index]->GameIndex = index;
+			Entities.pop_back();
+		}
+
+		entity->GameIndex = Entity::NotInGame;
+		delete entity;
+	}
+
+	std::vector<Entity*> spawned;
+	spawned.swap(SpawnCommands);
+
+	for (Entity* entity : spawned)
+	{
+		Storage.Adopt(*entity);
+
+		entity->SpawnQueued = false;
+		entity->GameIndex = Entities.size();
+		entity->SpawnSerial = NextSpawnSerial++;
+		Entities.push_back(entity);
+	}
+
+	for (Entity* entity : spawned)
+	{
+		entity->Start();
+	}
+
+	// Reuses the memory of the command buffers for the next frame
+	destroyed.clear();
+	spawned.clear();
+	if (DestroyCommands.empty())
+	{
+		DestroyCommands.swap(destroyed);
+	}
+	if (SpawnCommands.empty())
+	{
+		SpawnCommands.swap(spawned);
+	}
+}
+
+ArchetypeStorage& GameMgr::GetPendingStorage()
+{
+	return PendingStorage;
+}
+
+TransformHierarchy& GameMgr::GetHierarchy()
+{
+	return Hierarchy;
+}
+
+SpatialHashGrid& GameMgr::GetSpatialGrid()
+{
+	return SpatialGrid;
+}
+
+SpatialHashGrid& GameMgr::GetRenderGrid()
+{
+	return RenderGrid;
 }
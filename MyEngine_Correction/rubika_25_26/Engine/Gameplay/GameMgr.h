@@ -1,6 +1,12 @@
 #pragma once
 
+#include <Engine/Gameplay/Archetype/ArchetypeStorage.h>
+#include <Engine/Gameplay/Component/Transform/TransformHierarchy.h>
+#include <Engine/Gameplay/Spatial/SpatialHashGrid.h>
+
 #include <vector>
+#include <string>
+#include <cstdint>
 
 namespace sf
 {
@@ -18,7 +24,38 @@ public:
 	void Update(float deltaTime);
 	void Draw(sf::RenderWindow& window);
 
+	// Built in the pending storage, AddEntity puts it in the game
+	Entity* CreateEntity(const std::string& friendlyName = "");
+
+	// Spawns and destructions are queued, and applied together by FlushCommands at the end of Update:
+	// they are safe while the entities are being updated, and a destroyed entity stays valid until then
 	void AddEntity(Entity* entity);
+	void DestroyEntity(Entity* entity);
+
+	void FlushCommands();
+
+	// Storage of the entities built but not added to the game yet
+	ArchetypeStorage& GetPendingStorage();
+
+	TransformHierarchy& GetHierarchy();
+	SpatialHashGrid& GetSpatialGrid();
+
+	// Bounds of the entities drawables, used to only draw the entities in view
+	SpatialHashGrid& GetRenderGrid();
+
 private:
+	// Declared first: transforms leave the hierarchy and the grid when the storages destroy them
+	TransformHierarchy Hierarchy;
+	SpatialHashGrid SpatialGrid;
+	SpatialHashGrid RenderGrid;
+
 	std::vector<Entity*> Entities;
-};
\ No newline at end of file
+	std::vector<Entity*> VisibleEntities;
+
+	std::vector<Entity*> SpawnCommands;
+	std::vector<Entity*> DestroyCommands;
+	uint64_t NextSpawnSerial;
+
+	ArchetypeStorage Storage;
+	ArchetypeStorage PendingStorage;
+};
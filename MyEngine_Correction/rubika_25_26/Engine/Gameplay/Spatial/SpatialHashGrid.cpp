@@ -0,0 +1,430 @@
+#include "SpatialHashGrid.h"
+
+#include <Engine/Memory/MemoryTracker.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <assert.h>
+
+namespace
+{
+	bool Overlaps(const sf::FloatRect& a, const sf::FloatRect& b)
+	{
+		return a.position.x <= b.position.x + b.size.x && b.position.x <= a.position.x + a.size.x
+			&& a.position.y <= b.position.y + b.size.y && b.position.y <= a.position.y + a.size.y;
+	}
+
+	bool OverlapsCircle(const sf::FloatRect& bounds, sf::Vector2f center, float radius)
+	{
+		const float closestX = std::clamp(center.x, bounds.position.x, bounds.position.x + bounds.size.x);
+		const float closestY = std::clamp(center.y, bounds.position.y, bounds.position.y + bounds.size.y);
+		const float dx = center.x - closestX;
+		const float dy = center.y - closestY;
+		return dx * dx + dy * dy <= radius * radius;
+	}
+
+	// Slab test, returns the distance where the ray enters the bounds
+	bool IntersectRay(const sf::FloatRect& bounds, sf::Vector2f origin, sf::Vector2f direction, float maxDistance, float& distance)
+	{
+		float enter = 0.f;
+		float exit = maxDistance;
+
+		const float origins[2] = { origin.x, origin.y };
+		const float directions[2] = { direction.x, direction.y };
+		const float mins[2] = { bounds.position.x, bounds.position.y };
+		const float maxs[2] = { bounds.position.x + bounds.size.x, bounds.position.y + bounds.size.y };
+
+		for (int axis = 0; axis < 2; ++axis)
+		{
+			if (directions[axis] == 0.f)
+			{
+				if (origins[axis] < mins[axis] || origins[axis] > maxs[axis])
+				{
+					return false;
+				}
+				continue;
+			}
+
+			const float inverse = 1.f / directions[axis];
+			float entering = (mins[axis] - origins[axis]) * inverse;
+			float leaving = (maxs[axis] - origins[axis]) * inverse;
+			if (entering > leaving)
+			{
+				std::swap(entering, leaving);
+			}
+
+			enter = std::max(enter, entering);
+			exit = std::min(exit, leaving);
+			if (enter > exit)
+			{
+				return false;
+			}
+		}
+
+		distance = enter;
+		return true;
+	}
+}
+
+bool SpatialHashGrid::CellRange::operator==(const CellRange& other) const
+{
+	return MinX == other.MinX && MinY == other.MinY && MaxX == other.MaxX && MaxY == other.MaxY;
+}
+
+SpatialHashGrid::SpatialHashGrid(float cellSize) : CellSize(cellSize), InverseCellSize(1.f / cellSize), ProxyCount(0), CurrentQueryStamp(0)
+{
+	assert(cellSize > 0.f);
+}
+
+SpatialHashGrid::~SpatialHashGrid()
+{}
+
+uint32_t SpatialHashGrid::Insert(Entity& owner, const sf::FloatRect& bounds)
+{
+	MemoryTagScope scope(eMemoryTag::Spatial);
+
+	uint32_t proxy;
+	if (FreeProxies.size() != 0)
+	{
+		proxy = FreeProxies.back();
+		FreeProxies.pop_back();
+	}
+	else
+	{
+		proxy = (uint32_t)Proxies.size();
+		Proxies.emplace_back();
+	}
+
+	Proxy& data = Proxies[proxy];
+	data.Owner = &owner;
+	data.Bounds = bounds;
+	data.Cells = GetCellRange(bounds);
+	data.QueryStamp = 0;
+
+	Link(proxy, data.Cells);
+	++ProxyCount;
+
+	return proxy;
+}
+
+void SpatialHashGrid::Move(uint32_t proxy, const sf::FloatRect& bounds)
+{
+	assert(proxy < Proxies.size() && Proxies[proxy].Owner);
+
+	Proxy& data = Proxies[proxy];
+	data.Bounds = bounds;
+
+	// Most moves stay in the same cells: nothing to relink
+	const CellRange range = GetCellRange(bounds);
+	if (range == data.Cells)
+	{
+		return;
+	}
+
+	Unlink(proxy, data.Cells);
+	Link(proxy, range);
+	data.Cells = range;
+}
+
+void SpatialHashGrid::Remove(uint32_t proxy)
+{
+	assert(proxy < Proxies.size() && Proxies[proxy].Owner);
+
+	Unlink(proxy, Proxies[proxy].Cells);
+	Proxies[proxy].Owner = nullptr;
+
+	FreeProxies.push_back(proxy);
+	--ProxyCount;
+}
+
+void SpatialHashGrid::Rebuild()
+{
+	Cells.clear();
+
+	for (uint32_t proxy = 0; proxy < Proxies.size(); ++proxy)
+	{
+		Proxy& data = Proxies[proxy];
+		if (!data.Owner)
+		{
+			continue;
+		}
+
+		data.Cells = GetCellRange(data.Bounds);
+		Link(proxy, data.Cells);
+	}
+}
+
+Entity* SpatialHashGrid::GetOwner(uint32_t proxy) const
+{
+	assert(proxy < Proxies.size());
+	return Proxies[proxy].Owner;
+}
+
+const sf::FloatRect& SpatialHashGrid::GetBounds(uint32_t proxy) const
+{
+	assert(proxy < Proxies.size());
+	return Proxies[proxy].Bounds;
+}
+
+void SpatialHashGrid::QueryAabb(const sf::FloatRect& area, std::vector<Entity*>& results) const
+{
+	const uint32_t stamp = NextQueryStamp();
+	const CellRange range = GetCellRange(area);
+
+	for (int y = range.MinY; y <= range.MaxY; ++y)
+	{
+		for (int x = range.MinX; x <= range.MaxX; ++x)
+		{
+			const std::vector<uint32_t>* cell = FindCell(x, y);
+			if (!cell)
+			{
+				continue;
+			}
+
+			for (uint32_t proxy : *cell)
+			{
+				const Proxy& data = Proxies[proxy];
+				if (data.QueryStamp == stamp)
+				{
+					continue;
+				}
+
+				data.QueryStamp = stamp;
+				if (Overlaps(data.Bounds, area))
+				{
+					results.push_back(data.Owner);
+				}
+			}
+		}
+	}
+}
+
+void SpatialHashGrid::QueryRadius(sf::Vector2f center, float radius, std::vector<Entity*>& results) const
+{
+	const uint32_t stamp = NextQueryStamp();
+	const CellRange range = GetCellRange(sf::FloatRect(center - sf::Vector2f(radius, radius), sf::Vector2f(radius, radius) * 2.f));
+
+	for (int y = range.MinY; y <= range.MaxY; ++y)
+	{
+		for (int x = range.MinX; x <= range.MaxX; ++x)
+		{
+			const std::vector<uint32_t>* cell = FindCell(x, y);
+			if (!cell)
+			{
+				continue;
+			}
+
+			for (uint32_t proxy : *cell)
+			{
+				const Proxy& data = Proxies[proxy];
+				if (data.QueryStamp == stamp)
+				{
+					continue;
+				}
+
+				data.QueryStamp = stamp;
+				if (OverlapsCircle(data.Bounds, center, radius))
+				{
+					results.push_back(data.Owner);
+				}
+			}
+		}
+	}
+}
+
+void SpatialHashGrid::QueryRay(sf::Vector2f origin, sf::Vector2f direction, float maxDistance, std::vector<Entity*>& results) const
+{
+	const float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+	if (!(length > 0.f) || !std::isfinite(length) || !std::isfinite(origin.x) || !std::isfinite(origin.y))
+	{
+		return;
+	}
+	direction /= length;
+
+	// The walk must end even when the segment leaves the clamped world
+	maxDistance = std::min(maxDistance, 4.f * MaxWorldCoordinate);
+
+	const uint32_t stamp = NextQueryStamp();
+
+	std::vector<std::pair<float, Entity*>>& hits = RayHits;
+	hits.clear();
+
+	// Walks the cells crossed by the segment in order (Amanatides & Woo)
+	int x = ToCell(origin.x);
+	int y = ToCell(origin.y);
+	const int lastX = ToCell(origin.x + direction.x * maxDistance);
+	const int lastY = ToCell(origin.y + direction.y * maxDistance);
+
+	const int stepX = direction.x > 0.f ? 1 : -1;
+	const int stepY = direction.y > 0.f ? 1 : -1;
+
+	const float infinity = std::numeric_limits<float>::infinity();
+	const float deltaX = direction.x != 0.f ? CellSize / std::abs(direction.x) : infinity;
+	const float deltaY = direction.y != 0.f ? CellSize / std::abs(direction.y) : infinity;
+
+	const float nextBorderX = (x + (stepX > 0 ? 1 : 0)) * CellSize;
+	const float nextBorderY = (y + (stepY > 0 ? 1 : 0)) * CellSize;
+	float nextX = direction.x != 0.f ? (nextBorderX - origin.x) / direction.x : infinity;
+	float nextY = direction.y != 0.f ? (nextBorderY - origin.y) / direction.y : infinity;
+
+	while (true)
+	{
+		if (const std::vector<uint32_t>* cell = FindCell(x, y))
+		{
+			for (uint32_t proxy : *cell)
+			{
+				const Proxy& data = Proxies[proxy];
+				if (data.QueryStamp == stamp)
+				{
+					continue;
+				}
+
+				data.QueryStamp = stamp;
+
+				float distance;
+				if (IntersectRay(data.Bounds, origin, direction, maxDistance, distance))
+				{
+					hits.emplace_back(distance, data.Owner);
+				}
+			}
+		}
+
+		if (x == lastX && y == lastY)
+		{
+			break;
+		}
+
+		if (nextX < nextY)
+		{
+			if (nextX > maxDistance)
+			{
+				break;
+			}
+			x += stepX;
+			nextX += deltaX;
+		}
+		else
+		{
+			if (nextY > maxDistance)
+			{
+				break;
+			}
+			y += stepY;
+			nextY += deltaY;
+		}
+	}
+
+	std::sort(hits.begin(), hits.end(), [](const std::pair<float, Entity*>& a, const std::pair<float, Entity*>& b)
+	{
+		return a.first < b.first;
+	});
+
+	for (const std::pair<float, Entity*>& hit : hits)
+	{
+		results.push_back(hit.second);
+	}
+}
+
+float SpatialHashGrid::GetCellSize() const
+{
+	return CellSize;
+}
+
+size_t SpatialHashGrid::GetProxyCount() const
+{
+	return ProxyCount;
+}
+
+size_t SpatialHashGrid::GetCellCount() const
+{
+	return Cells.size();
+}
+
+int SpatialHashGrid::ToCell(float coordinate) const
+{
+	// Converting an infinite, NaN or out of range float to int is undefined. std::clamp would let NaN through
+	if (!(coordinate > -MaxWorldCoordinate))
+	{
+		coordinate = -MaxWorldCoordinate;
+	}
+	else if (coordinate > MaxWorldCoordinate)
+	{
+		coordinate = MaxWorldCoordinate;
+	}
+
+	return (int)std::floor(coordinate * InverseCellSize);
+}
+
+SpatialHashGrid::CellRange SpatialHashGrid::GetCellRange(const sf::FloatRect& bounds) const
+{
+	return CellRange
+	{
+		ToCell(bounds.position.x),
+		ToCell(bounds.position.y),
+		ToCell(bounds.position.x + bounds.size.x),
+		ToCell(bounds.position.y + bounds.size.y)
+	};
+}
+
+uint64_t SpatialHashGrid::GetCellKey(int x, int y)
+{
+	return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+}
+
+void SpatialHashGrid::Link(uint32_t proxy, const CellRange& range)
+{
+	MemoryTagScope scope(eMemoryTag::Spatial);
+
+	for (int y = range.MinY; y <= range.MaxY; ++y)
+	{
+		for (int x = range.MinX; x <= range.MaxX; ++x)
+		{
+			Cells[GetCellKey(x, y)].push_back(proxy);
+		}
+	}
+}
+
+void SpatialHashGrid::Unlink(uint32_t proxy, const CellRange& range)
+{
+	for (int y = range.MinY; y <= range.MaxY; ++y)
+	{
+		for (int x = range.MinX; x <= range.MaxX; ++x)
+		{
+			// Empty cells are kept to reuse their memory, Rebuild releases them
+			std::vector<uint32_t>& cell = Cells[GetCellKey(x, y)];
+			const auto& it = std::find(cell.begin(), cell.end(), proxy);
+			assert(it != cell.end());
+
+			*it = cell.back();
+			cell.pop_back();
+		}
+	}
+}
+
+const std::vector<uint32_t>* SpatialHashGrid::FindCell(int x, int y) const
+{
+	const auto& it = Cells.find(GetCellKey(x, y));
+	if (it == Cells.end() || it->second.empty())
+	{
+		return nullptr;
+	}
+
+	return &it->second;
+}
+
+uint32_t SpatialHashGrid::NextQueryStamp() const
+{
+	// Proxies start at 0, so a wrapping counter must skip it
+	if (++CurrentQueryStamp == 0)
+	{
+		for (const Proxy& data : Proxies)
+		{
+			data.QueryStamp = 0;
+		}
+		CurrentQueryStamp = 1;
+	}
+
+	return CurrentQueryStamp;
+}
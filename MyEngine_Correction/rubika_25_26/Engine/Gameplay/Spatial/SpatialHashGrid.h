@@ -0,0 +1,96 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+
+class Entity;
+
+// Uniform grid of square cells, stored sparsely in a hash map so the world has no fixed size.
+// Every proxy is an entity bounding box linked in each cell it overlaps.
+// Moving a proxy only relinks it when the range of cells it covers changes, which keeps
+// the cost of thousands of small moving objects close to a bounds copy each.
+// Queries are not thread safe: they stamp the proxies to report each one only once.
+class SpatialHashGrid
+{
+public:
+	SpatialHashGrid(float cellSize = 64.f);
+	~SpatialHashGrid();
+
+	SpatialHashGrid(const SpatialHashGrid&) = delete;
+	SpatialHashGrid& operator=(const SpatialHashGrid&) = delete;
+
+	static constexpr uint32_t InvalidProxy = 0xFFFFFFFF;
+
+	// Coordinates are clamped to this range: entities flung further, or with NaN bounds, pile up in the border cells
+	static constexpr float MaxWorldCoordinate = 1000000.f;
+
+	uint32_t Insert(Entity& owner, const sf::FloatRect& bounds);
+	void Move(uint32_t proxy, const sf::FloatRect& bounds);
+	void Remove(uint32_t proxy);
+
+	// Relinks every proxy from scratch, and forgets the cells left empty
+	void Rebuild();
+
+	Entity* GetOwner(uint32_t proxy) const;
+	const sf::FloatRect& GetBounds(uint32_t proxy) const;
+
+	// Results are appended to the vector, each entity once
+	void QueryAabb(const sf::FloatRect& area, std::vector<Entity*>& results) const;
+	void QueryRadius(sf::Vector2f center, float radius, std::vector<Entity*>& results) const;
+
+	// Entities whose bounds are crossed by the segment, sorted from the closest to the farthest
+	void QueryRay(sf::Vector2f origin, sf::Vector2f direction, float maxDistance, std::vector<Entity*>& results) const;
+
+	float GetCellSize() const;
+	size_t GetProxyCount() const;
+	size_t GetCellCount() const;
+
+private:
+	struct CellRange
+	{
+		int MinX;
+		int MinY;
+		int MaxX;
+		int MaxY;
+
+		bool operator==(const CellRange& other) const;
+	};
+
+	struct Proxy
+	{
+		Entity* Owner;
+		sf::FloatRect Bounds;
+		CellRange Cells;
+		mutable uint32_t QueryStamp;
+	};
+
+	float CellSize;
+	float InverseCellSize;
+
+	std::vector<Proxy> Proxies;
+	std::vector<uint32_t> FreeProxies;
+	size_t ProxyCount;
+
+	// Proxies overlapping each cell, keyed by the packed cell coordinates
+	std::unordered_map<uint64_t, std::vector<uint32_t>> Cells;
+
+	mutable uint32_t CurrentQueryStamp;
+
+	// Reused by QueryRay to sort its hits
+	mutable std::vector<std::pair<float, Entity*>> RayHits;
+
+	int ToCell(float coordinate) const;
+	CellRange GetCellRange(const sf::FloatRect& bounds) const;
+	static uint64_t GetCellKey(int x, int y);
+
+	void Link(uint32_t proxy, const CellRange& range);
+	void Unlink(uint32_t proxy, const CellRange& range);
+
+	const std::vector<uint32_t>* FindCell(int x, int y) const;
+	uint32_t NextQueryStamp() const;
+};
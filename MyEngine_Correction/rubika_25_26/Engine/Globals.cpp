@@ -4,15 +4,32 @@
 #include <Engine/Render/Ressource/TextureMgr.h>
 #include <Engine/Debug/DebugMgr.h>
 #include <Engine/Console/LogConsole.h>
+#include <Engine/Render/Batch/SpriteBatcher.h>
+#include <Engine/Ressource/AssetPack.h>
+#include <Engine/Render/Animation/AnimationSystem.h>
+#include <Engine/Gameplay/Collision/CollisionSystem.h>
+#include <Engine/Job/JobSystem.h>
+#include <Engine/Profiler/CpuProfiler.h>
+#include <Engine/Memory/MemoryTracker.h>
+#include <Engine/Memory/FrameArena.h>
 
 Globals gData;
 
 Globals::Globals() : FrameCount(0)
 {
+	// First: the other managers may record events as soon as they are built
+	Profiler = new ::CpuProfiler();
 	GameMgr = new ::GameMgr();
 	TextureMgr = new ::TextureMgr();
 	DebugMgr = new ::DebugMgr();
 	Console = new ::Logger();
+	SpriteBatcher = new ::SpriteBatcher();
+	AssetPack = new ::AssetPack();
+	AnimationSystem = new ::AnimationSystem();
+	CollisionSystem = new ::CollisionSystem();
+	JobSystem = new ::JobSystem();
+	MemoryTracker = new ::MemoryTracker();
+	FrameArena = new ::FrameArena();
 }
 
 Globals::~Globals()
@@ -22,10 +39,22 @@ Globals::~Globals()
 
 void Globals::Init()
 {
+	// Optional: assets are read from their loose files when the pack isn't cooked
+	const std::filesystem::path ressourcesPath = "../Ressources";
+	AssetPack->Mount(ressourcesPath / ::AssetPack::DefaultFileName, ressourcesPath);
+
+	Profiler->Init();
+
 	//GameMgr->Init();
 	TextureMgr->Init();
 	//DebugMgr->Init();
 	Console->Init();
+	SpriteBatcher->Init();
+	AnimationSystem->Init();
+	CollisionSystem->Init();
+	JobSystem->Init();
+	MemoryTracker->Init();
+	FrameArena->Init();
 }
 
 void Globals::Shut()
@@ -34,6 +63,14 @@ void Globals::Shut()
 	TextureMgr->Shut();
 	//DebugMgr->Shut();
 	Console->Shut();
+	SpriteBatcher->Shut();
+	AnimationSystem->Shut();
+	CollisionSystem->Shut();
+	JobSystem->Shut();
+	MemoryTracker->Shut();
+	FrameArena->Shut();
+	AssetPack->Unmount();
+	Profiler->Shut();
 }
 
 void Globals::Destroy()
@@ -44,9 +81,37 @@ void Globals::Destroy()
 	delete GameMgr;
 	GameMgr = nullptr;
 
+	// After the GameMgr: its sprites release their animation slots
+	delete AnimationSystem;
+	AnimationSystem = nullptr;
+
+	delete CollisionSystem;
+	CollisionSystem = nullptr;
+
+	// After the GameMgr: the storages may still update through it
+	delete JobSystem;
+	JobSystem = nullptr;
+
 	delete TextureMgr;
 	TextureMgr = nullptr;
 
 	delete Console;
 	Console = nullptr;
+
+	delete SpriteBatcher;
+	SpriteBatcher = nullptr;
+
+	delete AssetPack;
+	AssetPack = nullptr;
+
+	delete MemoryTracker;
+	MemoryTracker = nullptr;
+
+	// After the SpriteBatcher and the GameMgr: nothing allocates from it anymore
+	delete FrameArena;
+	FrameArena = nullptr;
+
+	// Last: every thread writing events is joined
+	delete Profiler;
+	Profiler = nullptr;
 }
@@ -6,6 +6,14 @@ class RandomMgr;
 class DebugMgr;
 class GameMgr;
 class Logger;
+class SpriteBatcher;
+class AssetPack;
+class AnimationSystem;
+class CollisionSystem;
+class JobSystem;
+class CpuProfiler;
+class MemoryTracker;
+class FrameArena;
 
 class Globals
 {
@@ -23,6 +31,14 @@ public:
 	TextureMgr* TextureMgr;
 	DebugMgr* DebugMgr;
 	Logger* Console;
+	SpriteBatcher* SpriteBatcher;
+	AssetPack* AssetPack;
+	AnimationSystem* AnimationSystem;
+	CollisionSystem* CollisionSystem;
+	JobSystem* JobSystem;
+	CpuProfiler* Profiler;
+	MemoryTracker* MemoryTracker;
+	FrameArena* FrameArena;
 };
 
 extern Globals gData;
\ No newline at end of file
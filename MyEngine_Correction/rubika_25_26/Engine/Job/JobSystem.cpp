@@ -0,0 +1,292 @@
+#include "JobSystem.h"
+
+#include <Engine/Globals.h>
+#include <Engine/Profiler.h>
+#include <Engine/Memory/MemoryTracker.h>
+
+#ifdef _USE_IMGUI
+#include <Imgui/imgui.h>
+#endif
+
+#include <assert.h>
+
+JobCounter::JobCounter() : Value(0)
+{}
+
+JobCounter::~JobCounter()
+{
+	assert(IsDone() && "A job still references this counter");
+}
+
+bool JobCounter::IsDone() const
+{
+	return Value.load(std::memory_order_acquire) == 0;
+}
+
+thread_local size_t JobSystem::ThreadIndex = JobSystem::InvalidThreadIndex;
+
+JobSystem::JobSystem() : QueuedJobCount(0), SleepingWorkerCount(0), StopWorkers(false), ParallelForEach(true)
+{
+	// Globals are built by the main thread
+	ThreadIndex = MainThreadIndex;
+	Queues.push_back(new ThreadQueue());
+}
+
+JobSystem::~JobSystem()
+{
+	Shut();
+
+	for (ThreadQueue* queue : Queues)
+	{
+		delete queue;
+	}
+	Queues.clear();
+}
+
+void JobSystem::Init()
+{
+	if (!Workers.empty())
+	{
+		return;
+	}
+
+	// The main thread works too while it waits
+	const unsigned int coreCount = std::thread::hardware_concurrency();
+	const size_t workerCount = std::min<size_t>(coreCount > 1 ? coreCount - 1 : 0, MaxWorkerCount);
+
+	MemoryTagScope scope(eMemoryTag::Jobs);
+
+	// Every queue exists before the first worker looks for a job to steal
+	for (size_t i = 0; i < workerCount; ++i)
+	{
+		Queues.push_back(new ThreadQueue());
+	}
+
+	StopWorkers = false;
+	for (size_t i = 0; i < workerCount; ++i)
+	{
+		Workers.emplace_back(&JobSystem::WorkerLoop, this, i + 1);
+	}
+
+	gData.DebugMgr->RegisterDebugableWindow("JobSystem", this);
+}
+
+void JobSystem::Shut()
+{
+	if (Workers.empty())
+	{
+		return;
+	}
+
+	gData.DebugMgr->UnregisterDebugableWindow("JobSystem");
+
+	{
+		std::lock_guard<std::mutex> lock(SleepMutex);
+		StopWorkers = true;
+	}
+	SleepCondition.notify_all();
+
+	for (std::thread& worker : Workers)
+	{
+		worker.join();
+	}
+	Workers.clear();
+
+	for (size_t i = 1; i < Queues.size(); ++i)
+	{
+		assert(Queues[i]->Deque.GetSize() == 0);
+		delete Queues[i];
+	}
+	Queues.resize(1);
+}
+
+void JobSystem::Schedule(JobFunction function, void* data, size_t begin, size_t end, JobCounter* counter, const JobCounter* dependency)
+{
+	assert(ThreadIndex != InvalidThreadIndex && "Jobs are scheduled from the main thread or from other jobs");
+
+	if (counter)
+	{
+		counter->Value.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	const Job job { function, data, begin, end, counter, dependency };
+
+	ThreadQueue& queue = *Queues[ThreadIndex];
+	Job* slot = &queue.Jobs[queue.NextJob % JobRingSize];
+	*slot = job;
+
+	if (Workers.empty() || !queue.Deque.Push(slot))
+	{
+		Execute(job);
+		return;
+	}
+
+	++queue.NextJob;
+	QueuedJobCount.fetch_add(1, std::memory_order_seq_cst);
+	WakeWorker();
+}
+
+void JobSystem::Wait(const JobCounter& counter)
+{
+	assert(ThreadIndex != InvalidThreadIndex && "Jobs are waited from the main thread or from other jobs");
+
+	while (!counter.IsDone())
+	{
+		Job job;
+		if (TakeJob(job))
+		{
+			Execute(job);
+		}
+		else
+		{
+			// The last jobs of the counter are running on other threads
+			std::this_thread::yield();
+		}
+	}
+}
+
+size_t JobSystem::GetThreadCount() const
+{
+	return Workers.size() + 1;
+}
+
+bool JobSystem::IsParallelForEachEnabled() const
+{
+	return ParallelForEach && !Workers.empty();
+}
+
+void JobSystem::DrawDebug()
+{
+#ifdef _USE_IMGUI
+	ImGui::Text("Threads: %u (%u workers)", (unsigned int)GetThreadCount(), (unsigned int)Workers.size());
+	ImGui::Checkbox("Parallel renderer sync", &ParallelForEach);
+
+	if (ImGui::BeginTable("Threads", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+	{
+		ImGui::TableSetupColumn("Thread");
+		ImGui::TableSetupColumn("Executed");
+		ImGui::TableSetupColumn("Stolen");
+		ImGui::TableHeadersRow();
+
+		for (size_t i = 0; i < Queues.size(); ++i)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			if (i == MainThreadIndex)
+			{
+				ImGui::Text("Main");
+			}
+			else
+			{
+				ImGui::Text("Worker %u", (unsigned int)i);
+			}
+			ImGui::TableNextColumn();
+			ImGui::Text("%llu", (unsigned long long)Queues[i]->ExecutedCount.load(std::memory_order_relaxed));
+			ImGui::TableNextColumn();
+			ImGui::Text("%llu", (unsigned long long)Queues[i]->StolenCount.load(std::memory_order_relaxed));
+		}
+
+		ImGui::EndTable();
+	}
+#endif
+}
+
+size_t JobSystem::GetBatchCount(size_t count, size_t minBatchSize) const
+{
+	if (Workers.empty() || count == 0)
+	{
+		return 1;
+	}
+
+	// A few batches per thread so the ones finishing first can steal the rest
+	const size_t maxBatchCount = GetThreadCount() * 4;
+	const size_t batchCount = (count + std::max<size_t>(minBatchSize, 1) - 1) / std::max<size_t>(minBatchSize, 1);
+	return std::min(batchCount, maxBatchCount);
+}
+
+bool JobSystem::TakeJob(Job& job)
+{
+	ThreadQueue& queue = *Queues[ThreadIndex];
+
+	Job* taken = nullptr;
+	if (queue.Deque.Pop(taken))
+	{
+		job = *taken;
+		QueuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	// Starts with the next thread so the thieves don't all hit the same victim
+	for (size_t i = 1; i < Queues.size(); ++i)
+	{
+		ThreadQueue& victim = *Queues[(ThreadIndex + i) % Queues.size()];
+		if (victim.Deque.Steal(taken))
+		{
+			job = *taken;
+			QueuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+			queue.StolenCount.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::Execute(const Job& job)
+{
+	// Runs other jobs meanwhile, one of them may be the dependency
+	if (job.Dependency)
+	{
+		Wait(*job.Dependency);
+	}
+
+	PROFILER_EVENT_BEGIN(PROFILER_COLOR_YELLOW, "Job");
+	job.Function(job.Data, job.Begin, job.End);
+	PROFILER_EVENT_END();
+
+	if (job.Counter)
+	{
+		job.Counter->Value.fetch_sub(1, std::memory_order_release);
+	}
+
+	Queues[ThreadIndex]->ExecutedCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void JobSystem::WorkerLoop(size_t index)
+{
+	ThreadIndex = index;
+	PROFILER_THREAD_NAME("Job worker");
+
+	while (true)
+	{
+		Job job;
+		if (TakeJob(job))
+		{
+			Execute(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(SleepMutex);
+		SleepingWorkerCount.fetch_add(1, std::memory_order_seq_cst);
+		SleepCondition.wait(lock, [this]()
+		{
+			return StopWorkers || QueuedJobCount.load(std::memory_order_seq_cst) > 0;
+		});
+		SleepingWorkerCount.fetch_sub(1, std::memory_order_relaxed);
+
+		if (StopWorkers)
+		{
+			return;
+		}
+	}
+}
+
+void JobSystem::WakeWorker()
+{
+	// Pairs with the sleeping count incremented before the queued count is checked: one of the two sides sees the other
+	if (SleepingWorkerCount.load(std::memory_order_seq_cst) > 0)
+	{
+		std::lock_guard<std::mutex> lock(SleepMutex);
+		SleepCondition.notify_one();
+	}
+}
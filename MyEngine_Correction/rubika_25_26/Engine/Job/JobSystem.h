@@ -0,0 +1,121 @@
+#pragma once
+
+#include <Engine/Debug/DebugMgr.h>
+#include <Engine/Job/WorkStealingDeque.h>
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+// Runs on any thread the jobs function(data, begin, end)
+using JobFunction = void (*)(void* data, size_t begin, size_t end);
+
+// Number of jobs left in a group: incremented when a job is scheduled, decremented once it ran
+class JobCounter
+{
+public:
+	JobCounter();
+	~JobCounter();
+
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	bool IsDone() const;
+
+	friend class JobSystem;
+
+private:
+	std::atomic<int> Value;
+};
+
+// One worker per core besides the main thread, each with its own work stealing deque.
+// A thread runs the jobs it scheduled first, and steals from the others when it has none left.
+// Waiting on a counter runs jobs instead of blocking, so jobs can schedule and wait on other jobs.
+// Schedule and Wait can only be called from the main thread and from jobs.
+class JobSystem final : public IDebugable
+{
+public:
+	JobSystem();
+	~JobSystem();
+
+	void Init();
+	void Shut();
+
+	// The job won't start before the dependency reached 0.
+	// Without workers, or when the deque of the thread is full, the job runs right away
+	void Schedule(JobFunction function, void* data, size_t begin, size_t end, JobCounter* counter, const JobCounter* dependency = nullptr);
+	void Wait(const JobCounter& counter);
+
+	// Splits [0, count[ in batches of at least minBatchSize and calls function(begin, end) on each of them.
+	// Returns once every batch ran, the calling thread takes its share of the batches
+	template <typename F>
+	void ParallelFor(size_t count, size_t minBatchSize, F&& function);
+
+	// Workers and main thread
+	size_t GetThreadCount() const;
+
+	// ArchetypeStorage::ParallelForEach only splits the chunks between the threads when enabled.
+	// The renderers catching up with their transform are its only user
+	bool IsParallelForEachEnabled() const;
+
+	virtual void DrawDebug() override;
+
+private:
+	struct Job
+	{
+		JobFunction Function;
+		void* Data;
+		size_t Begin;
+		size_t End;
+		JobCounter* Counter;
+		const JobCounter* Dependency;
+	};
+
+	static constexpr size_t DequeCapacity = 4096;
+
+	// Twice the deque, so a slot is only reused long after the job was taken and copied
+	static constexpr size_t JobRingSize = DequeCapacity * 2;
+
+	static constexpr size_t MainThreadIndex = 0;
+	static constexpr size_t InvalidThreadIndex = (size_t)-1;
+	static constexpr size_t MaxWorkerCount = 31;
+
+	struct ThreadQueue
+	{
+		WorkStealingDeque<Job*, DequeCapacity> Deque;
+
+		// Only written by the owner thread
+		Job Jobs[JobRingSize];
+		size_t NextJob = 0;
+
+		// Read by the debug tab
+		std::atomic<uint64_t> ExecutedCount = 0;
+		std::atomic<uint64_t> StolenCount = 0;
+	};
+
+	// Index 0 is the main thread, then one per worker. Never resized while the workers run
+	std::vector<ThreadQueue*> Queues;
+	std::vector<std::thread> Workers;
+
+	std::mutex SleepMutex;
+	std::condition_variable SleepCondition;
+	std::atomic<int> QueuedJobCount;
+	std::atomic<int> SleepingWorkerCount;
+	std::atomic<bool> StopWorkers;
+
+	bool ParallelForEach;
+
+	static thread_local size_t ThreadIndex;
+
+	size_t GetBatchCount(size_t count, size_t minBatchSize) const;
+
+	bool TakeJob(Job& job);
+	void Execute(const Job& job);
+	void WorkerLoop(size_t index);
+	void WakeWorker();
+};
+
+#include "JobSystem.hxx"
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <type_traits>
+
+template <typename F>
+inline void JobSystem::ParallelFor(size_t count, size_t minBatchSize, F&& function)
+{
+	using Function = std::remove_reference_t<F>;
+
+	const size_t batchCount = GetBatchCount(count, minBatchSize);
+	if (batchCount <= 1)
+	{
+		if (count != 0)
+		{
+			function((size_t)0, count);
+		}
+		return;
+	}
+
+	const size_t batchSize = (count + batchCount - 1) / batchCount;
+
+	// The function lives on this stack until Wait returns
+	JobCounter counter;
+	for (size_t begin = batchSize; begin < count; begin += batchSize)
+	{
+		Schedule([](void* data, size_t first, size_t last)
+		{
+			(*static_cast<Function*>(data))(first, last);
+		}, const_cast<void*>(static_cast<const void*>(&function)), begin, std::min(begin + batchSize, count), &counter);
+	}
+
+	function((size_t)0, batchSize);
+	Wait(counter);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Fixed size Chase-Lev deque (Le et al. 2013 memory orders).
+// The owner thread pushes and pops at the bottom in LIFO order, which keeps the work it just split hot in its cache,
+// any other thread steals at the top the oldest and usually biggest jobs.
+// T must be trivially copyable, in practice a pointer.
+template <typename T, size_t Capacity>
+class WorkStealingDeque
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "The capacity must be a power of 2");
+
+public:
+	WorkStealingDeque();
+
+	WorkStealingDeque(const WorkStealingDeque&) = delete;
+	WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+	// Owner thread only. Fails when the deque is full
+	bool Push(T value);
+	bool Pop(T& value);
+
+	// Any thread
+	bool Steal(T& value);
+
+	size_t GetSize() const;
+
+private:
+	static constexpr int64_t Mask = (int64_t)Capacity - 1;
+
+	// On their own cache line: thieves hammer Top while the owner works on Bottom
+	alignas(64) std::atomic<int64_t> Top;
+	alignas(64) std::atomic<int64_t> Bottom;
+	alignas(64) std::atomic<T> Buffer[Capacity];
+};
+
+#include "WorkStealingDeque.hxx"
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "WorkStealingDeque.h"
+
+template <typename T, size_t Capacity>
+inline WorkStealingDeque<T, Capacity>::WorkStealingDeque() : Top(0), Bottom(0)
+{}
+
+template <typename T, size_t Capacity>
+inline bool WorkStealingDeque<T, Capacity>::Push(T value)
+{
+	const int64_t bottom = Bottom.load(std::memory_order_relaxed);
+	const int64_t top = Top.load(std::memory_order_acquire);
+	if (bottom - top >= (int64_t)Capacity)
+	{
+		return false;
+	}
+
+	Buffer[bottom & Mask].store(value, std::memory_order_relaxed);
+
+	// The value must be visible before a thief sees the new bottom
+	Bottom.store(bottom + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T, size_t Capacity>
+inline bool WorkStealingDeque<T, Capacity>::Pop(T& value)
+{
+	const int64_t bottom = Bottom.load(std::memory_order_relaxed) - 1;
+	Bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = Top.load(std::memory_order_relaxed);
+
+	if (top > bottom)
+	{
+		// Empty
+		Bottom.store(bottom + 1, std::memory_order_relaxed);
+		return false;
+	}
+
+	value = Buffer[bottom & Mask].load(std::memory_order_relaxed);
+	if (top != bottom)
+	{
+		return true;
+	}
+
+	// Last value: races with the thieves on Top
+	const bool won = Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	Bottom.store(bottom + 1, std::memory_order_relaxed);
+	return won;
+}
+
+template <typename T, size_t Capacity>
+inline bool WorkStealingDeque<T, Capacity>::Steal(T& value)
+{
+	int64_t top = Top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const int64_t bottom = Bottom.load(std::memory_order_acquire);
+
+	if (top >= bottom)
+	{
+		return false;
+	}
+
+	value = Buffer[top & Mask].load(std::memory_order_relaxed);
+	return Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+template <typename T, size_t Capacity>
+inline size_t WorkStealingDeque<T, Capacity>::GetSize() const
+{
+	const int64_t size = Bottom.load(std::memory_order_relaxed) - Top.load(std::memory_order_relaxed);
+	return size > 0 ? (size_t)size : 0;
+}
@@ -0,0 +1,46 @@
+#include "Affine2D.h"
+
+#include <cmath>
+
+Affine2D Affine2D::Compose(sf::Vector2f position, float rotationInDegrees, sf::Vector2f scale)
+{
+	const float radians = rotationInDegrees * 3.141592654f / 180.f;
+	const float cosine = std::cos(radians);
+	const float sine = std::sin(radians);
+
+	Affine2D result;
+	result.A = cosine * scale.x;
+	result.B = -sine * scale.y;
+	result.Tx = position.x;
+	result.C = sine * scale.x;
+	result.D = cosine * scale.y;
+	result.Ty = position.y;
+	return result;
+}
+
+Affine2D Affine2D::GetInverse() const
+{
+	const float determinant = A * D - B * C;
+	if (determinant == 0.f)
+	{
+		return Identity;
+	}
+
+	const float inverseDeterminant = 1.f / determinant;
+
+	Affine2D result;
+	result.A = D * inverseDeterminant;
+	result.B = -B * inverseDeterminant;
+	result.C = -C * inverseDeterminant;
+	result.D = A * inverseDeterminant;
+	result.Tx = -(result.A * Tx + result.B * Ty);
+	result.Ty = -(result.C * Tx + result.D * Ty);
+	return result;
+}
+
+sf::Transform Affine2D::ToSfml() const
+{
+	return sf::Transform(A, B, Tx,
+		C, D, Ty,
+		0.f, 0.f, 1.f);
+}
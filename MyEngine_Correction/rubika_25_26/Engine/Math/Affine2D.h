@@ -0,0 +1,91 @@
+#pragma once
+
+#include <Engine/Simd.h>
+
+#include <SFML/Graphics/Transform.hpp>
+#include <SFML/System/Vector2.hpp>
+
+// 2D affine transform stored as the first two rows of a 3x3 matrix:
+// | A  B  Tx |
+// | C  D  Ty |
+// 24 bytes instead of the 64 of an sf::Transform, which is only built when SFML needs one.
+struct Affine2D
+{
+	float A = 1.f;
+	float B = 0.f;
+	float Tx = 0.f;
+	float C = 0.f;
+	float D = 1.f;
+	float Ty = 0.f;
+
+	static const Affine2D Identity;
+
+	// Same result as translating, rotating then scaling an sf::Transform
+	static Affine2D Compose(sf::Vector2f position, float rotationInDegrees, sf::Vector2f scale);
+
+	// Applies other first, like sf::Transform
+	Affine2D operator*(const Affine2D& other) const;
+
+	sf::Vector2f TransformPoint(sf::Vector2f point) const;
+	sf::Vector2f GetTranslation() const;
+
+	// Returns the identity if the transform can't be inverted
+	Affine2D GetInverse() const;
+
+	sf::Transform ToSfml() const;
+
+	bool operator==(const Affine2D& other) const;
+	bool operator!=(const Affine2D& other) const;
+};
+
+static_assert(sizeof(Affine2D) == 6 * sizeof(float), "Affine2D must stay packed, the SIMD multiply relies on it");
+
+inline const Affine2D Affine2D::Identity = Affine2D();
+
+inline Affine2D Affine2D::operator*(const Affine2D& other) const
+{
+	Affine2D result;
+
+#ifdef USE_SSE2
+	// Rows of other as (A, B, Tx, _) and (C, D, Ty, _), both loaded inside the struct
+	const __m128 row0 = _mm_loadu_ps(&other.A);
+	const __m128 row1 = _mm_shuffle_ps(_mm_loadu_ps(&other.Tx), _mm_loadu_ps(&other.Tx), _MM_SHUFFLE(0, 3, 2, 1));
+
+	const __m128 result0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(A), row0), _mm_mul_ps(_mm_set1_ps(B), row1)), _mm_setr_ps(0.f, 0.f, Tx, 0.f));
+	const __m128 result1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(C), row0), _mm_mul_ps(_mm_set1_ps(D), row1)), _mm_setr_ps(0.f, 0.f, Ty, 0.f));
+
+	// The last lane of the first row lands on C and is overwritten by the second row
+	_mm_storeu_ps(&result.A, result0);
+	_mm_storel_pi(reinterpret_cast<__m64*>(&result.C), result1);
+	_mm_store_ss(&result.Ty, _mm_shuffle_ps(result1, result1, _MM_SHUFFLE(2, 2, 2, 2)));
+#else
+	result.A = A * other.A + B * other.C;
+	result.B = A * other.B + B * other.D;
+	result.Tx = A * other.Tx + B * other.Ty + Tx;
+	result.C = C * other.A + D * other.C;
+	result.D = C * other.B + D * other.D;
+	result.Ty = C * other.Tx + D * other.Ty + Ty;
+#endif
+
+	return result;
+}
+
+inline sf::Vector2f Affine2D::TransformPoint(sf::Vector2f point) const
+{
+	return sf::Vector2f(A * point.x + B * point.y + Tx, C * point.x + D * point.y + Ty);
+}
+
+inline sf::Vector2f Affine2D::GetTranslation() const
+{
+	return sf::Vector2f(Tx, Ty);
+}
+
+inline bool Affine2D::operator==(const Affine2D& other) const
+{
+	return A == other.A && B == other.B && Tx == other.Tx && C == other.C && D == other.D && Ty == other.Ty;
+}
+
+inline bool Affine2D::operator!=(const Affine2D& other) const
+{
+	return !(*this == other);
+}
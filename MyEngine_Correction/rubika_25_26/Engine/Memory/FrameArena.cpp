@@ -0,0 +1,167 @@
+#include "FrameArena.h"
+
+#include <Engine/Globals.h>
+#include <Engine/Console/LogConsole.h>
+#include <Engine/Memory/MemoryTracker.h>
+
+#ifdef _USE_IMGUI
+#include <Imgui/imgui.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <string>
+#include <assert.h>
+
+namespace
+{
+	// Cache line aligned so two threads never share the line of a fresh allocation
+	constexpr size_t BufferAlignment = 64;
+
+	float ToKilobytes(size_t bytes)
+	{
+		return (float)bytes / 1024.f;
+	}
+}
+
+FrameArena::FrameArena(size_t capacity) : CurrentBuffer(0), Capacity(capacity), LastFrameUsedBytes(0), HighWaterMark(0),
+	LastFrameOverflowCount(0), LastFrameOverflowBytes(0), TotalOverflowCount(0)
+{
+	MemoryTagScope scope(eMemoryTag::FrameArena);
+
+	for (Buffer& buffer : Buffers)
+	{
+		buffer.Memory = static_cast<unsigned char*>(::operator new(Capacity, std::align_val_t(BufferAlignment)));
+		buffer.Offset = 0;
+		buffer.OverflowCount = 0;
+		buffer.OverflowBytes = 0;
+	}
+}
+
+FrameArena::~FrameArena()
+{
+	for (Buffer& buffer : Buffers)
+	{
+		Reset(buffer);
+		::operator delete(buffer.Memory, std::align_val_t(BufferAlignment));
+		buffer.Memory = nullptr;
+	}
+}
+
+void FrameArena::Init()
+{
+	gData.DebugMgr->RegisterDebugableWindow("FrameArena", this);
+}
+
+void FrameArena::Shut()
+{
+	gData.DebugMgr->UnregisterDebugableWindow("FrameArena");
+}
+
+void FrameArena::BeginFrame()
+{
+	// Diagnostics of the frame that just ended
+	Buffer& previous = Buffers[CurrentBuffer];
+	LastFrameUsedBytes = previous.Offset.load(std::memory_order_relaxed);
+	LastFrameOverflowCount = previous.OverflowCount.load(std::memory_order_relaxed);
+	LastFrameOverflowBytes = previous.OverflowBytes.load(std::memory_order_relaxed);
+	HighWaterMark = std::max(HighWaterMark, LastFrameUsedBytes + LastFrameOverflowBytes);
+
+	if (LastFrameOverflowCount != 0)
+	{
+		TotalOverflowCount += LastFrameOverflowCount;
+		Logger::Warning("FrameArena: " + std::to_string(LastFrameOverflowCount) + " allocations (" + std::to_string(LastFrameOverflowBytes)
+			+ " bytes) didn't fit in the " + std::to_string(Capacity) + " bytes of the last frame and went to the heap");
+	}
+
+	// The buffer of the frame before is free again
+	CurrentBuffer ^= 1;
+	Reset(Buffers[CurrentBuffer]);
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0 && "The alignment must be a power of two");
+
+	Buffer& buffer = Buffers[CurrentBuffer];
+	const uintptr_t base = (uintptr_t)buffer.Memory;
+
+	size_t offset = buffer.Offset.load(std::memory_order_relaxed);
+	while (true)
+	{
+		const size_t begin = (size_t)(((base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base);
+		const size_t end = begin + size;
+		if (end > Capacity)
+		{
+			return AllocateOverflow(buffer, size, alignment);
+		}
+
+		if (buffer.Offset.compare_exchange_weak(offset, end, std::memory_order_relaxed))
+		{
+			return buffer.Memory + begin;
+		}
+	}
+}
+
+size_t FrameArena::GetCapacity() const
+{
+	return Capacity;
+}
+
+size_t FrameArena::GetUsedBytes() const
+{
+	return Buffers[CurrentBuffer].Offset.load(std::memory_order_relaxed);
+}
+
+void FrameArena::DrawDebug()
+{
+#ifdef _USE_IMGUI
+	const size_t usedBytes = GetUsedBytes();
+
+	ImGui::Text("Capacity: %.1f KB per frame, two frames", ToKilobytes(Capacity));
+	ImGui::ProgressBar((float)usedBytes / (float)Capacity, ImVec2(-1.f, 0.f), (std::to_string((int)ToKilobytes(usedBytes)) + " KB used").c_str());
+
+	ImGui::Text("Last frame: %.1f KB", ToKilobytes(LastFrameUsedBytes));
+	ImGui::Text("High water mark: %.1f KB", ToKilobytes(HighWaterMark));
+
+	if (LastFrameOverflowCount != 0)
+	{
+		ImGui::TextColored(ImVec4(1.f, 0.3f, 0.3f, 1.f), "Last frame overflow: %zu allocations, %.1f KB", LastFrameOverflowCount, ToKilobytes(LastFrameOverflowBytes));
+	}
+	ImGui::Text("Overflowed allocations since start: %llu", (unsigned long long)TotalOverflowCount);
+#endif
+}
+
+void* FrameArena::AllocateOverflow(Buffer& buffer, size_t size, size_t alignment)
+{
+	MemoryTagScope scope(eMemoryTag::FrameArena);
+
+	alignment = std::max<size_t>(alignment, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+	void* memory = ::operator new(std::max<size_t>(size, 1), std::align_val_t(alignment));
+
+	buffer.OverflowCount.fetch_add(1, std::memory_order_relaxed);
+	buffer.OverflowBytes.fetch_add(size, std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(OverflowMutex);
+	buffer.OverflowBlocks.push_back(OverflowBlock{ memory, alignment });
+	return memory;
+}
+
+void FrameArena::Reset(Buffer& buffer)
+{
+#ifdef _DEBUG
+	// Data kept past its second frame reads garbage instead of looking valid
+	std::memset(buffer.Memory, 0xCD, buffer.Offset.load(std::memory_order_relaxed));
+#endif
+
+	for (const OverflowBlock& block : buffer.OverflowBlocks)
+	{
+		::operator delete(block.Memory, std::align_val_t(block.Alignment));
+	}
+	buffer.OverflowBlocks.clear();
+
+	buffer.Offset.store(0, std::memory_order_relaxed);
+	buffer.OverflowCount.store(0, std::memory_order_relaxed);
+	buffer.OverflowBytes.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <Engine/Debug/DebugMgr.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Linear allocator for the transient data of a frame: allocating is a bump of an offset, freeing does nothing.
+// Two buffers are used in turn, so memory allocated during a frame stays valid until the end of the next one.
+// Allocations exceeding the capacity go to the heap, are released with their buffer and reported once the frame is over.
+// Allocate can run on any thread, BeginFrame must run on the main thread while no job is in flight.
+class FrameArena final : public IDebugable
+{
+public:
+	static constexpr size_t DefaultCapacity = 4 * 1024 * 1024;
+
+	FrameArena(size_t capacity = DefaultCapacity);
+	~FrameArena();
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	void Init();
+	void Shut();
+
+	// Releases everything allocated two frames ago
+	void BeginFrame();
+
+	// Never fails, the memory is uninitialized
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	template <typename T>
+	T* AllocateArray(size_t count);
+
+	size_t GetCapacity() const;
+	size_t GetUsedBytes() const;
+
+	virtual void DrawDebug() override;
+
+private:
+	struct OverflowBlock
+	{
+		void* Memory;
+		size_t Alignment;
+	};
+
+	struct Buffer
+	{
+		unsigned char* Memory;
+		std::atomic<size_t> Offset;
+
+		std::vector<OverflowBlock> OverflowBlocks;
+		std::atomic<size_t> OverflowCount;
+		std::atomic<size_t> OverflowBytes;
+	};
+
+	Buffer Buffers[2];
+	size_t CurrentBuffer;
+	size_t Capacity;
+
+	std::mutex OverflowMutex;
+
+	size_t LastFrameUsedBytes;
+	size_t HighWaterMark;
+	size_t LastFrameOverflowCount;
+	size_t LastFrameOverflowBytes;
+	uint64_t TotalOverflowCount;
+
+	void* AllocateOverflow(Buffer& buffer, size_t size, size_t alignment);
+	void Reset(Buffer& buffer);
+};
+
+// Standard allocator taking its memory from a FrameArena. Deallocating does nothing:
+// a container using it must not outlive the next frame, and shouldn't grow much more than it is reserved.
+template <typename T>
+class FrameAllocator
+{
+public:
+	using value_type = T;
+
+	FrameAllocator(FrameArena& arena);
+
+	template <typename U>
+	FrameAllocator(const FrameAllocator<U>& other);
+
+	T* allocate(size_t count);
+	void deallocate(T* pointer, size_t count);
+
+	template <typename U>
+	bool operator==(const FrameAllocator<U>& other) const;
+	template <typename U>
+	bool operator!=(const FrameAllocator<U>& other) const;
+
+	template <typename U>
+	friend class FrameAllocator;
+
+private:
+	FrameArena* Arena;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+#include "FrameArena.hxx"
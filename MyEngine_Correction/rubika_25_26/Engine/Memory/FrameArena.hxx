@@ -0,0 +1,42 @@
+#pragma once
+
+#include "FrameArena.h"
+
+template <typename T>
+inline T* FrameArena::AllocateArray(size_t count)
+{
+	return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+}
+
+template <typename T>
+inline FrameAllocator<T>::FrameAllocator(FrameArena& arena) : Arena(&arena)
+{}
+
+template <typename T>
+template <typename U>
+inline FrameAllocator<T>::FrameAllocator(const FrameAllocator<U>& other) : Arena(other.Arena)
+{}
+
+template <typename T>
+inline T* FrameAllocator<T>::allocate(size_t count)
+{
+	return Arena->AllocateArray<T>(count);
+}
+
+template <typename T>
+inline void FrameAllocator<T>::deallocate(T*, size_t)
+{}
+
+template <typename T>
+template <typename U>
+inline bool FrameAllocator<T>::operator==(const FrameAllocator<U>& other) const
+{
+	return Arena == other.Arena;
+}
+
+template <typename T>
+template <typename U>
+inline bool FrameAllocator<T>::operator!=(const FrameAllocator<U>& other) const
+{
+	return Arena != other.Arena;
+}
@@ -0,0 +1,421 @@
+#include "MemoryTracker.h"
+
+#include <Engine/Globals.h>
+#include <Engine/Console/LogConsole.h>
+
+#ifdef _USE_IMGUI
+#include <Imgui/imgui.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+
+namespace
+{
+	const char* TagNames[] =
+	{
+		"Untagged",
+		"Textures",
+		"Animations",
+		"Entities",
+		"Components",
+		"Rendering",
+		"Collision",
+		"Spatial",
+		"Jobs",
+		"Profiler",
+		"Console",
+		"Debug",
+		"FrameArena"
+	};
+	static_assert(sizeof(TagNames) / sizeof(TagNames[0]) == (size_t)eMemoryTag::Count, "Every tag needs a name");
+
+	float ToKilobytes(size_t bytes)
+	{
+		return (float)bytes / 1024.f;
+	}
+}
+
+const char* GetMemoryTagName(eMemoryTag tag)
+{
+	return (size_t)tag < (size_t)eMemoryTag::Count ? TagNames[(size_t)tag] : "Invalid";
+}
+
+MemoryTracker::AtomicTagStats MemoryTracker::Stats[(size_t)eMemoryTag::Count] = {};
+thread_local eMemoryTag MemoryTracker::CurrentTag = eMemoryTag::Untagged;
+
+MemoryTracker::MemoryTracker() : MarkedLiveBytes{}, HasMark(false)
+{}
+
+MemoryTracker::~MemoryTracker()
+{}
+
+void MemoryTracker::Init()
+{
+	gData.DebugMgr->RegisterDebugableWindow("Memory", this);
+	gData.DebugMgr->RegisterDebugAction("Dump memory report", [](void* userData)
+	{
+		const MemoryTracker* tracker = static_cast<const MemoryTracker*>(userData);
+		const std::filesystem::path path = std::filesystem::path("../Captures") / ("Memory_Frame_" + std::to_string(gData.FrameCount) + ".txt");
+		if (tracker->DumpReport(path))
+		{
+			Logger::Info("Memory report written to " + path.string());
+		}
+		else
+		{
+			Logger::Error("Can't write the memory report " + path.string());
+		}
+	}, this);
+}
+
+void MemoryTracker::Shut()
+{
+	gData.DebugMgr->UnregisterDebugAction("Dump memory report");
+	gData.DebugMgr->UnregisterDebugableWindow("Memory");
+}
+
+bool MemoryTracker::IsTracking()
+{
+#ifdef USE_MEMORY_TRACKING
+	return true;
+#else
+	return false;
+#endif
+}
+
+MemoryTracker::TagStats MemoryTracker::GetStats(eMemoryTag tag)
+{
+	const AtomicTagStats& stats = Stats[(size_t)tag];
+	return TagStats
+	{
+		stats.LiveBytes.load(std::memory_order_relaxed),
+		stats.PeakBytes.load(std::memory_order_relaxed),
+		stats.LiveAllocations.load(std::memory_order_relaxed),
+		stats.TotalAllocations.load(std::memory_order_relaxed)
+	};
+}
+
+void MemoryTracker::OnAllocate(eMemoryTag tag, size_t size)
+{
+	AtomicTagStats& stats = Stats[(size_t)tag];
+
+	const size_t live = stats.LiveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+	stats.LiveAllocations.fetch_add(1, std::memory_order_relaxed);
+	stats.TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	size_t peak = stats.PeakBytes.load(std::memory_order_relaxed);
+	while (live > peak && !stats.PeakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+	{}
+}
+
+void MemoryTracker::OnFree(eMemoryTag tag, size_t size)
+{
+	AtomicTagStats& stats = Stats[(size_t)tag];
+	stats.LiveBytes.fetch_sub(size, std::memory_order_relaxed);
+	stats.LiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+}
+
+eMemoryTag MemoryTracker::GetCurrentTag()
+{
+	return CurrentTag;
+}
+
+void MemoryTracker::SetCurrentTag(eMemoryTag tag)
+{
+	CurrentTag = tag;
+}
+
+void MemoryTracker::ResetPeaks()
+{
+	for (AtomicTagStats& stats : Stats)
+	{
+		stats.PeakBytes.store(stats.LiveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+}
+
+void MemoryTracker::Mark()
+{
+	for (size_t tag = 0; tag < (size_t)eMemoryTag::Count; ++tag)
+	{
+		MarkedLiveBytes[tag] = Stats[tag].LiveBytes.load(std::memory_order_relaxed);
+	}
+	HasMark = true;
+}
+
+bool MemoryTracker::DumpReport(const std::filesystem::path& path) const
+{
+	MemoryTagScope scope(eMemoryTag::Debug);
+
+	std::error_code error;
+	if (path.has_parent_path())
+	{
+		std::filesystem::create_directories(path.parent_path(), error);
+	}
+
+	FILE* file = std::fopen(path.string().c_str(), "w");
+	if (!file)
+	{
+		return false;
+	}
+
+	std::fprintf(file, "Memory report, frame %u%s\n\n", gData.FrameCount, IsTracking() ? "" : " (compiled without USE_MEMORY_TRACKING)");
+	std::fprintf(file, "%-12s %14s %14s %12s %14s %14s\n", "Tag", "Live (KB)", "Peak (KB)", "Live allocs", "Total allocs", "Since mark (KB)");
+
+	TagStats total {};
+	for (size_t tag = 0; tag < (size_t)eMemoryTag::Count; ++tag)
+	{
+		const TagStats stats = GetStats((eMemoryTag)tag);
+		const float sinceMark = HasMark ? ToKilobytes(stats.LiveBytes) - ToKilobytes(MarkedLiveBytes[tag]) : 0.f;
+
+		std::fprintf(file, "%-12s %14.1f %14.1f %12zu %14llu %14.1f\n", GetMemoryTagName((eMemoryTag)tag), ToKilobytes(stats.LiveBytes), ToKilobytes(stats.PeakBytes),
+			stats.LiveAllocations, (unsigned long long)stats.TotalAllocations, sinceMark);
+
+		total.LiveBytes += stats.LiveBytes;
+		total.PeakBytes += stats.PeakBytes;
+		total.LiveAllocations += stats.LiveAllocations;
+		total.TotalAllocations += stats.TotalAllocations;
+	}
+
+	// Peaks of different tags happen at different times: their sum is an upper bound
+	std::fprintf(file, "%-12s %14.1f %14.1f %12zu %14llu\n", "Total", ToKilobytes(total.LiveBytes), ToKilobytes(total.PeakBytes),
+		total.LiveAllocations, (unsigned long long)total.TotalAllocations);
+
+	const bool written = std::ferror(file) == 0;
+	std::fclose(file);
+	return written;
+}
+
+void MemoryTracker::DrawDebug()
+{
+#ifdef _USE_IMGUI
+	if (!IsTracking())
+	{
+		ImGui::Text("Compiled without USE_MEMORY_TRACKING: nothing is counted");
+		return;
+	}
+
+	if (ImGui::Button("Reset peaks"))
+	{
+		ResetPeaks();
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Mark"))
+	{
+		Mark();
+	}
+
+	if (ImGui::BeginTable("##Memory", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable))
+	{
+		ImGui::TableSetupColumn("Tag");
+		ImGui::TableSetupColumn("Live (KB)");
+		ImGui::TableSetupColumn("Peak (KB)");
+		ImGui::TableSetupColumn("Live allocs");
+		ImGui::TableSetupColumn("Total allocs");
+		ImGui::TableSetupColumn("Since mark (KB)");
+		ImGui::TableHeadersRow();
+
+		for (size_t tag = 0; tag < (size_t)eMemoryTag::Count; ++tag)
+		{
+			const TagStats stats = GetStats((eMemoryTag)tag);
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::Text("%s", GetMemoryTagName((eMemoryTag)tag));
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", ToKilobytes(stats.LiveBytes));
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", ToKilobytes(stats.PeakBytes));
+			ImGui::TableNextColumn();
+			ImGui::Text("%zu", stats.LiveAllocations);
+			ImGui::TableNextColumn();
+			ImGui::Text("%llu", (unsigned long long)stats.TotalAllocations);
+			ImGui::TableNextColumn();
+			if (HasMark)
+			{
+				// Growing tags are the ones to look at for leaks
+				const float delta = ToKilobytes(stats.LiveBytes) - ToKilobytes(MarkedLiveBytes[tag]);
+				ImGui::TextColored(delta > 0.f ? ImVec4(1.f, 0.5f, 0.f, 1.f) : ImVec4(0.5f, 1.f, 0.5f, 1.f), "%+.1f", delta);
+			}
+			else
+			{
+				ImGui::TextDisabled("-");
+			}
+		}
+
+		ImGui::EndTable();
+	}
+#endif
+}
+
+#ifdef USE_MEMORY_TRACKING
+
+// Every block starts with a header giving its size and its tag back when it is freed
+namespace
+{
+	struct AllocationHeader
+	{
+		size_t Size;
+		uint32_t Offset;
+		eMemoryTag Tag;
+	};
+
+	constexpr size_t HeaderSize = 16;
+	static_assert(sizeof(AllocationHeader) <= HeaderSize, "The header must fit before the block");
+
+	void* TrackedAllocate(size_t size, size_t alignment)
+	{
+		alignment = std::max(alignment, HeaderSize);
+
+		// The padded size would wrap and malloc return a block too small for the header and the data
+		if (size > SIZE_MAX - alignment - HeaderSize)
+		{
+			return nullptr;
+		}
+
+		unsigned char* raw = static_cast<unsigned char*>(std::malloc(size + alignment + HeaderSize));
+		if (!raw)
+		{
+			return nullptr;
+		}
+
+		const uintptr_t first = (uintptr_t)raw + HeaderSize;
+		unsigned char* block = (unsigned char*)((first + alignment - 1) & ~(uintptr_t)(alignment - 1));
+
+		AllocationHeader* header = reinterpret_cast<AllocationHeader*>(block - HeaderSize);
+		header->Size = size;
+		header->Offset = (uint32_t)(block - raw);
+		header->Tag = MemoryTracker::GetCurrentTag();
+
+		MemoryTracker::OnAllocate(header->Tag, size);
+		return block;
+	}
+
+	void TrackedFree(void* pointer)
+	{
+		if (!pointer)
+		{
+			return;
+		}
+
+		unsigned char* block = static_cast<unsigned char*>(pointer);
+		const AllocationHeader* header = reinterpret_cast<const AllocationHeader*>(block - HeaderSize);
+
+		MemoryTracker::OnFree(header->Tag, header->Size);
+		std::free(block - header->Offset);
+	}
+
+	void* TrackedAllocateOrThrow(size_t size, size_t alignment)
+	{
+		void* pointer = TrackedAllocate(size != 0 ? size : 1, alignment);
+		if (!pointer)
+		{
+			throw std::bad_alloc();
+		}
+		return pointer;
+	}
+}
+
+void* operator new(size_t size)
+{
+	return TrackedAllocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](size_t size)
+{
+	return TrackedAllocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	return TrackedAllocateOrThrow(size, (size_t)alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return TrackedAllocateOrThrow(size, (size_t)alignment);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return TrackedAllocate(size != 0 ? size : 1, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return TrackedAllocate(size != 0 ? size : 1, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return TrackedAllocate(size != 0 ? size : 1, (size_t)alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return TrackedAllocate(size != 0 ? size : 1, (size_t)alignment);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	TrackedFree(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	TrackedFree(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+	TrackedFree(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+	TrackedFree(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+	TrackedFree(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+	TrackedFree(pointer);
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept
+{
+	TrackedFree(pointer);
+}
+
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept
+{
+	TrackedFree(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+	TrackedFree(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+	TrackedFree(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	TrackedFree(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	TrackedFree(pointer);
+}
+
+#endif
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <Engine/Debug/DebugMgr.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+
+// Subsystem an allocation is charged to
+enum class eMemoryTag : uint8_t
+{
+	Untagged,
+	Textures,
+	Animations,
+	Entities,
+	Components,
+	Rendering,
+	Collision,
+	Spatial,
+	Jobs,
+	Profiler,
+	Console,
+	Debug,
+	FrameArena,
+	Count
+};
+
+const char* GetMemoryTagName(eMemoryTag tag);
+
+// Live bytes, peak bytes and allocation counts per tag.
+// With USE_MEMORY_TRACKING the global operator new and delete are replaced: every allocation is charged
+// to the tag of the innermost MemoryTagScope of its thread, or to the tag of its TaggedAllocator.
+// Without it, nothing is counted and the scopes and allocators cost nothing.
+class MemoryTracker final : public IDebugable
+{
+public:
+	MemoryTracker();
+	~MemoryTracker();
+
+	void Init();
+	void Shut();
+
+	struct TagStats
+	{
+		size_t LiveBytes;
+		size_t PeakBytes;
+		size_t LiveAllocations;
+		uint64_t TotalAllocations;
+	};
+
+	static bool IsTracking();
+	static TagStats GetStats(eMemoryTag tag);
+
+	// Any thread, called by the allocation hook
+	static void OnAllocate(eMemoryTag tag, size_t size);
+	static void OnFree(eMemoryTag tag, size_t size);
+
+	static eMemoryTag GetCurrentTag();
+	static void SetCurrentTag(eMemoryTag tag);
+
+	// Peaks start again from the live bytes
+	static void ResetPeaks();
+
+	// Live memory compared to the last mark, to find what a game phase leaves behind
+	void Mark();
+
+	bool DumpReport(const std::filesystem::path& path) const;
+
+	virtual void DrawDebug() override;
+
+private:
+	struct AtomicTagStats
+	{
+		std::atomic<size_t> LiveBytes;
+		std::atomic<size_t> PeakBytes;
+		std::atomic<size_t> LiveAllocations;
+		std::atomic<uint64_t> TotalAllocations;
+	};
+
+	// Constant initialized: allocations of the static constructors are counted too
+	static AtomicTagStats Stats[(size_t)eMemoryTag::Count];
+	static thread_local eMemoryTag CurrentTag;
+
+	size_t MarkedLiveBytes[(size_t)eMemoryTag::Count];
+	bool HasMark;
+};
+
+// Charges the allocations of the thread to a tag until the end of the scope
+class MemoryTagScope
+{
+public:
+	MemoryTagScope(eMemoryTag tag);
+	~MemoryTagScope();
+
+	MemoryTagScope(const MemoryTagScope&) = delete;
+	MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+
+private:
+#ifdef USE_MEMORY_TRACKING
+	eMemoryTag PreviousTag;
+#endif
+};
+
+// Standard allocator charging a container to a tag, whichever scope it grows in
+template <typename T, eMemoryTag Tag>
+class TaggedAllocator
+{
+public:
+	using value_type = T;
+
+	template <typename U>
+	struct rebind
+	{
+		using other = TaggedAllocator<U, Tag>;
+	};
+
+	TaggedAllocator() = default;
+
+	template <typename U>
+	TaggedAllocator(const TaggedAllocator<U, Tag>&)
+	{}
+
+	T* allocate(size_t count);
+	void deallocate(T* pointer, size_t count);
+
+	template <typename U>
+	bool operator==(const TaggedAllocator<U, Tag>&) const
+	{
+		return true;
+	}
+
+	template <typename U>
+	bool operator!=(const TaggedAllocator<U, Tag>&) const
+	{
+		return false;
+	}
+};
+
+#include "MemoryTracker.hxx"
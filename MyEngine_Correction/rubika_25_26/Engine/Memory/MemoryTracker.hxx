@@ -0,0 +1,54 @@
+#pragma once
+
+#include "MemoryTracker.h"
+
+#include <new>
+
+inline MemoryTagScope::MemoryTagScope(eMemoryTag tag)
+#ifdef USE_MEMORY_TRACKING
+	: PreviousTag(MemoryTracker::GetCurrentTag())
+#endif
+{
+#ifdef USE_MEMORY_TRACKING
+	MemoryTracker::SetCurrentTag(tag);
+#else
+	(void)tag;
+#endif
+}
+
+inline MemoryTagScope::~MemoryTagScope()
+{
+#ifdef USE_MEMORY_TRACKING
+	MemoryTracker::SetCurrentTag(PreviousTag);
+#endif
+}
+
+template <typename T, eMemoryTag Tag>
+inline T* TaggedAllocator<T, Tag>::allocate(size_t count)
+{
+	// The hook charges the block to the tag of the scope
+	MemoryTagScope scope(Tag);
+
+	if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+	{
+		return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(alignof(T))));
+	}
+	else
+	{
+		return static_cast<T*>(::operator new(count * sizeof(T)));
+	}
+}
+
+template <typename T, eMemoryTag Tag>
+inline void TaggedAllocator<T, Tag>::deallocate(T* pointer, size_t count)
+{
+	// Freed blocks are given back to the tag they were charged to
+	if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+	{
+		::operator delete(pointer, count * sizeof(T), std::align_val_t(alignof(T)));
+	}
+	else
+	{
+		::operator delete(pointer, count * sizeof(T));
+	}
+}
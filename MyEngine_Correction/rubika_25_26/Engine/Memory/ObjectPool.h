@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// Fixed size allocator for one type: freed slots are chained in a free list and reused first,
+// new slots are allocated by chunks so the pool never moves the live objects.
+// Not thread safe, objects must be created and destroyed on the main thread.
+template <typename T>
+class ObjectPool
+{
+public:
+	ObjectPool(size_t objectsPerChunk = 64);
+	~ObjectPool();
+
+	ObjectPool(const ObjectPool&) = delete;
+	ObjectPool& operator=(const ObjectPool&) = delete;
+
+	// Raw memory for one T, the caller constructs it
+	void* Allocate();
+	void Deallocate(void* object);
+
+	size_t GetLiveCount() const;
+	size_t GetCapacity() const;
+
+	// Pool shared by every pooled T
+	static ObjectPool& Get();
+
+private:
+	union Slot
+	{
+		Slot* Next;
+		alignas(T) unsigned char Storage[sizeof(T)];
+	};
+
+	std::vector<Slot*> Chunks;
+	Slot* FreeList;
+	size_t ObjectsPerChunk;
+	size_t LiveCount;
+
+	void Grow();
+};
+
+// Routes new and delete of T through its ObjectPool.
+// Classes deriving from T without their own pool don't have the same size and use the heap.
+template <typename T>
+class PooledObject
+{
+public:
+	static void* operator new(size_t size);
+	static void operator delete(void* object, size_t size);
+};
+
+#include "ObjectPool.hxx"
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "ObjectPool.h"
+
+#include <new>
+#include <assert.h>
+
+template <typename T>
+inline ObjectPool<T>::ObjectPool(size_t objectsPerChunk) : FreeList(nullptr), ObjectsPerChunk(objectsPerChunk), LiveCount(0)
+{
+	assert(objectsPerChunk > 0);
+}
+
+template <typename T>
+inline ObjectPool<T>::~ObjectPool()
+{
+	// Objects still alive at this point are leaked by their owner, their memory goes away with the pool
+	for (Slot* chunk : Chunks)
+	{
+		::operator delete(chunk, std::align_val_t(alignof(Slot)));
+	}
+
+	Chunks.clear();
+}
+
+template <typename T>
+inline void* ObjectPool<T>::Allocate()
+{
+	if (!FreeList)
+	{
+		Grow();
+	}
+
+	Slot* slot = FreeList;
+	FreeList = slot->Next;
+
+	++LiveCount;
+	return slot->Storage;
+}
+
+template <typename T>
+inline void ObjectPool<T>::Deallocate(void* object)
+{
+	if (!object)
+	{
+		return;
+	}
+
+	assert(LiveCount > 0);
+
+	Slot* slot = static_cast<Slot*>(object);
+	slot->Next = FreeList;
+	FreeList = slot;
+
+	--LiveCount;
+}
+
+template <typename T>
+inline size_t ObjectPool<T>::GetLiveCount() const
+{
+	return LiveCount;
+}
+
+template <typename T>
+inline size_t ObjectPool<T>::GetCapacity() const
+{
+	return Chunks.size() * ObjectsPerChunk;
+}
+
+template <typename T>
+inline ObjectPool<T>& ObjectPool<T>::Get()
+{
+	static ObjectPool pool;
+	return pool;
+}
+
+template <typename T>
+inline void ObjectPool<T>::Grow()
+{
+	Slot* chunk = static_cast<Slot*>(::operator new(sizeof(Slot) * ObjectsPerChunk, std::align_val_t(alignof(Slot))));
+	Chunks.push_back(chunk);
+
+	// Chained backward so the first slot of the chunk is handed out first
+	for (size_t i = ObjectsPerChunk; i > 0; --i)
+	{
+		chunk[i - 1].Next = FreeList;
+		FreeList = &chunk[i - 1];
+	}
+}
+
+template <typename T>
+inline void* PooledObject<T>::operator new(size_t size)
+{
+	if (size != sizeof(T))
+	{
+		return ::operator new(size);
+	}
+
+	return ObjectPool<T>::Get().Allocate();
+}
+
+template <typename T>
+inline void PooledObject<T>::operator delete(void* object, size_t size)
+{
+	if (size != sizeof(T))
+	{
+		::operator delete(object);
+		return;
+	}
+
+	ObjectPool<T>::Get().Deallocate(object);
+}
@@ -1,40 +1,62 @@
 #pragma once
 
+// Events go to PIX with USE_PIX, and to the in-engine CpuProfiler with USE_PROFILER. Both can be enabled at once.
+
+#include <cstdint>
+
 #ifdef USE_PIX
 
+// Engine sources including this header use std::min and std::max
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
 #include <Windows.h>
 #include <pix3.h>
 
-#define PROFILER_COLOR_BLACK PIX_COLOR(0, 0, 0)
-#define PROFILER_COLOR_RED PIX_COLOR(255, 0, 0)
-#define PROFILER_COLOR_GREEN PIX_COLOR(0, 255, 0)
-#define PROFILER_COLOR_BLUE PIX_COLOR(0, 0, 255)
-#define PROFILER_COLOR_WHITE PIX_COLOR(255, 255, 255)
-#define PROFILER_COLOR_CYAN PIX_COLOR(43, 255, 255)
-#define PROFILER_COLOR_PURPLE PIX_COLOR(128, 0, 128)
-#define PROFILER_COLOR_ORANGE PIX_COLOR(255, 128, 0)
-#define PROFILER_COLOR_YELLOW PIX_COLOR(255, 255, 0)
-#define PROFILER_COLOR_PINK PIX_COLOR(255, 192, 203)
-#define PROFILER_COLOR_BROWN PIX_COLOR(128, 0, 0)
-
-#define PROFILER_EVENT_BEGIN(color, ...) PIXBeginEvent(color, __VA_ARGS__)
-#define PROFILER_EVENT_END() PIXEndEvent()
+#define PROFILER_COLOR(r, g, b) PIX_COLOR(r, g, b)
+
+#define PROFILER_PIX_EVENT_BEGIN(color, ...) PIXBeginEvent(color, __VA_ARGS__)
+#define PROFILER_PIX_EVENT_END() PIXEndEvent()
+
+#else
+
+// Same layout as PIX_COLOR
+#define PROFILER_COLOR(r, g, b) ((uint64_t)(0xFF000000u | ((r) << 16) | ((g) << 8) | (b)))
+
+#define PROFILER_PIX_EVENT_BEGIN(color, ...)
+#define PROFILER_PIX_EVENT_END()
+
+#endif
+
+#ifdef USE_PROFILER
+
+#include <Engine/Profiler/CpuProfiler.h>
+
+#define PROFILER_CPU_EVENT_BEGIN(color, ...) CpuProfiler::BeginEvent(color, __VA_ARGS__)
+#define PROFILER_CPU_EVENT_END() CpuProfiler::EndEvent()
+#define PROFILER_THREAD_NAME(name) CpuProfiler::SetThreadName(name)
 
 #else
 
-#define PROFILER_COLOR_BLACK
-#define PROFILER_COLOR_RED
-#define PROFILER_COLOR_GREEN
-#define PROFILER_COLOR_BLUE
-#define PROFILER_COLOR_WHITE
-#define PROFILER_COLOR_CYAN
-#define PROFILER_COLOR_PURPLE
-#define PROFILER_COLOR_ORANGE
-#define PROFILER_COLOR_YELLOW
-#define PROFILER_COLOR_PINK
-#define PROFILER_COLOR_BROWN
-
-#define PROFILER_EVENT_BEGIN(color, ...)
-#define PROFILER_EVENT_END()
-
-#endif
\ No newline at end of file
+#define PROFILER_CPU_EVENT_BEGIN(color, ...)
+#define PROFILER_CPU_EVENT_END()
+#define PROFILER_THREAD_NAME(name)
+
+#endif
+
+#define PROFILER_COLOR_BLACK PROFILER_COLOR(0, 0, 0)
+#define PROFILER_COLOR_RED PROFILER_COLOR(255, 0, 0)
+#define PROFILER_COLOR_GREEN PROFILER_COLOR(0, 255, 0)
+#define PROFILER_COLOR_BLUE PROFILER_COLOR(0, 0, 255)
+#define PROFILER_COLOR_WHITE PROFILER_COLOR(255, 255, 255)
+#define PROFILER_COLOR_CYAN PROFILER_COLOR(43, 255, 255)
+#define PROFILER_COLOR_PURPLE PROFILER_COLOR(128, 0, 128)
+#define PROFILER_COLOR_ORANGE PROFILER_COLOR(255, 128, 0)
+#define PROFILER_COLOR_YELLOW PROFILER_COLOR(255, 255, 0)
+#define PROFILER_COLOR_PINK PROFILER_COLOR(255, 192, 203)
+#define PROFILER_COLOR_BROWN PROFILER_COLOR(128, 0, 0)
+
+// Names must be string literals. The CpuProfiler groups scopes by name and ignores the format arguments,
+// which only PIX uses: a name with a format specifier shows up as is in the panel and the traces
+#define PROFILER_EVENT_BEGIN(color, ...) do { PROFILER_PIX_EVENT_BEGIN(color, __VA_ARGS__); PROFILER_CPU_EVENT_BEGIN(color, __VA_ARGS__); } while (0)
+#define PROFILER_EVENT_END() do { PROFILER_CPU_EVENT_END(); PROFILER_PIX_EVENT_END(); } while (0)
@@ -0,0 +1,574 @@
+#include "CpuProfiler.h"
+
+#include <Engine/Globals.h>
+#include <Engine/Console/LogConsole.h>
+#include <Engine/Memory/MemoryTracker.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <assert.h>
+
+// The time stamp counter is invariant on every x86 cpu we ship on, and much cheaper to read than the steady clock
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define USE_RDTSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace
+{
+	int64_t GetSteadyNanoseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
+
+CpuProfiler* CpuProfiler::Instance = nullptr;
+thread_local CpuProfiler::ThreadBuffer* CpuProfiler::LocalBuffer = nullptr;
+std::atomic<bool> CpuProfiler::Enabled = false;
+
+CpuProfiler::CpuProfiler() : RequestedEnabled(true), RecordedFrameCount(0), FrameNumber(0), FrameStart(0), MsPerTick(1e-6),
+	CaptureFramesLeft(0), CaptureStartTicks(0), CaptureStarted(false), CaptureFirstEvent(false), Panel(*this)
+{
+	assert(!Instance && "A single profiler receives the events");
+	Instance = this;
+
+	MemoryTagScope scope(eMemoryTag::Profiler);
+	History.resize(HistorySize);
+
+	CalibrationTicks = GetTicks();
+	CalibrationNanoseconds = GetSteadyNanoseconds();
+}
+
+CpuProfiler::~CpuProfiler()
+{
+	Enabled = false;
+
+	// Every other thread is joined by now
+	LocalBuffer = nullptr;
+	Instance = nullptr;
+
+	for (ThreadBuffer* buffer : Buffers)
+	{
+		delete buffer;
+	}
+	Buffers.clear();
+}
+
+void CpuProfiler::Init()
+{
+	// First registered: the main thread is always the thread 0
+	SetThreadName("Main");
+
+	gData.DebugMgr->RegisterDebugableWindow("Profiler", &Panel);
+	gData.DebugMgr->RegisterDebugAction("Capture profiler trace", [](void* userData)
+	{
+		CpuProfiler* profiler = static_cast<CpuProfiler*>(userData);
+		const std::string fileName = "Frame_" + std::to_string(gData.FrameCount) + ".json";
+		profiler->StartCapture(std::filesystem::path("../Captures") / fileName, profiler->Panel.GetCaptureFrameCount());
+	}, this);
+}
+
+void CpuProfiler::Shut()
+{
+	StopCapture();
+
+	gData.DebugMgr->UnregisterDebugAction("Capture profiler trace");
+	gData.DebugMgr->UnregisterDebugableWindow("Profiler");
+}
+
+void CpuProfiler::BeginFrame()
+{
+	const bool wasEnabled = Enabled.load(std::memory_order_relaxed);
+	if (RequestedEnabled && !wasEnabled)
+	{
+		// Forgets what happened while disabled
+		std::lock_guard<std::mutex> lock(BuffersMutex);
+		for (ThreadBuffer* buffer : Buffers)
+		{
+			buffer->ReadIndex.store(buffer->WriteIndex.load(std::memory_order_acquire), std::memory_order_release);
+			buffer->Open.clear();
+		}
+	}
+	Enabled.store(RequestedEnabled, std::memory_order_relaxed);
+
+	FrameStart = GetTicks();
+}
+
+void CpuProfiler::EndFrame()
+{
+	MemoryTagScope scope(eMemoryTag::Profiler);
+	++FrameNumber;
+
+	if (!Enabled.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	Calibrate();
+
+	Frame& frame = History[RecordedFrameCount % HistorySize];
+	frame.Number = FrameNumber;
+	frame.Start = FrameStart;
+	frame.End = GetTicks();
+
+	std::lock_guard<std::mutex> lock(BuffersMutex);
+
+	// Vectors are reused from the frame this one replaces, only a new thread allocates
+	if (frame.Threads.size() < Buffers.size())
+	{
+		frame.Threads.resize(Buffers.size());
+	}
+
+	for (size_t thread = 0; thread < Buffers.size(); ++thread)
+	{
+		Drain(*Buffers[thread], frame.Threads[thread]);
+	}
+
+	++RecordedFrameCount;
+
+	if (CaptureFramesLeft != 0)
+	{
+		CaptureFrame(frame, gData.FrameCount);
+
+		if (--CaptureFramesLeft == 0)
+		{
+			StopCapture();
+		}
+	}
+}
+
+bool CpuProfiler::IsEnabled()
+{
+	return Enabled.load(std::memory_order_relaxed);
+}
+
+void CpuProfiler::SetEnabled(bool enabled)
+{
+	if (Instance)
+	{
+		Instance->RequestedEnabled = enabled;
+	}
+}
+
+void CpuProfiler::EndEvent()
+{
+	PushEvent(eEventType::End, 0, nullptr);
+}
+
+void CpuProfiler::SetThreadName(const char* name)
+{
+	ThreadBuffer* buffer = LocalBuffer ? LocalBuffer : RegisterThread();
+	if (!buffer)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(Instance->BuffersMutex);
+	std::snprintf(buffer->Name, ThreadNameSize, "%s", name);
+}
+
+size_t CpuProfiler::GetFrameCount() const
+{
+	return (size_t)std::min<uint64_t>(RecordedFrameCount, HistorySize);
+}
+
+const CpuProfiler::Frame& CpuProfiler::GetFrame(size_t age) const
+{
+	assert(age < GetFrameCount());
+	return History[(RecordedFrameCount - 1 - age) % HistorySize];
+}
+
+size_t CpuProfiler::GetThreadCount() const
+{
+	std::lock_guard<std::mutex> lock(BuffersMutex);
+	return Buffers.size();
+}
+
+const char* CpuProfiler::GetThreadName(size_t thread) const
+{
+	std::lock_guard<std::mutex> lock(BuffersMutex);
+	assert(thread < Buffers.size());
+	return Buffers[thread]->Name;
+}
+
+uint64_t CpuProfiler::GetDroppedEventCount() const
+{
+	std::lock_guard<std::mutex> lock(BuffersMutex);
+
+	uint64_t dropped = 0;
+	for (const ThreadBuffer* buffer : Buffers)
+	{
+		dropped += buffer->DroppedCount.load(std::memory_order_relaxed);
+	}
+	return dropped;
+}
+
+double CpuProfiler::TicksToMs(uint64_t ticks) const
+{
+	return (double)ticks * MsPerTick;
+}
+
+bool CpuProfiler::StartCapture(const std::filesystem::path& path, uint32_t frameCount)
+{
+	StopCapture();
+
+	if (frameCount == 0)
+	{
+		return false;
+	}
+
+	if (!CaptureWriter.Open(path))
+	{
+		Logger::Error("Profiler: can't open the capture file " + path.string());
+		return false;
+	}
+
+	CaptureChunk = CaptureWriter.AcquireChunk();
+	CaptureChunk.reserve(CaptureChunkSize + 4096);
+	CaptureChunk += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+	CaptureFramesLeft = frameCount;
+	CaptureStarted = false;
+	CaptureFirstEvent = true;
+
+	// Applied by the next BeginFrame, the capture starts with the first recorded frame
+	RequestedEnabled = true;
+
+	Logger::Info("Profiler: capturing " + std::to_string(frameCount) + " frames to " + path.string());
+	return true;
+}
+
+void CpuProfiler::StopCapture()
+{
+	if (!CaptureWriter.IsOpen())
+	{
+		return;
+	}
+
+	CaptureFramesLeft = 0;
+
+	char event[256];
+
+	// Names of the tracks, last so the threads named during the capture are included
+	AppendCaptureEvent("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"rubika_25_26\"}}");
+	{
+		std::lock_guard<std::mutex> lock(BuffersMutex);
+		for (size_t thread = 0; thread < Buffers.size(); ++thread)
+		{
+			std::snprintf(event, sizeof(event), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", (unsigned int)thread);
+			AppendCaptureEvent(event);
+			AppendJsonString(CaptureChunk, Buffers[thread]->Name[0] ? Buffers[thread]->Name : "Unnamed thread");
+			CaptureChunk += "}}";
+
+			std::snprintf(event, sizeof(event), "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"sort_index\":%u}}", (unsigned int)thread, (unsigned int)thread + 1);
+			AppendCaptureEvent(event);
+		}
+	}
+	std::snprintf(event, sizeof(event), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Frames\"}}", (unsigned int)FramesTrack);
+	AppendCaptureEvent(event);
+
+	CaptureChunk += "\n]}\n";
+	FlushCaptureChunk();
+
+	CaptureWriter.Close();
+
+	if (CaptureWriter.HasFailed())
+	{
+		Logger::Error("Profiler: failed to write the capture " + CaptureWriter.GetPath().string());
+	}
+	else
+	{
+		Logger::Info("Profiler: capture written to " + CaptureWriter.GetPath().string() + " (" + std::to_string(CaptureWriter.GetWrittenBytes() / 1024) + " KB)");
+	}
+}
+
+bool CpuProfiler::IsCapturing() const
+{
+	return CaptureWriter.IsOpen();
+}
+
+uint32_t CpuProfiler::GetCaptureFramesLeft() const
+{
+	return CaptureFramesLeft;
+}
+
+size_t CpuProfiler::GetCaptureWrittenBytes() const
+{
+	return CaptureWriter.GetWrittenBytes();
+}
+
+void CpuProfiler::PushEvent(eEventType type, uint64_t color, const char* name)
+{
+	if (!Enabled.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	ThreadBuffer* buffer = LocalBuffer ? LocalBuffer : RegisterThread();
+	if (!buffer)
+	{
+		return;
+	}
+
+	if (type == eEventType::Begin)
+	{
+		const uint64_t write = buffer->WriteIndex.load(std::memory_order_relaxed);
+		const uint64_t free = EventCapacity - (write - buffer->ReadIndex.load(std::memory_order_acquire));
+		if (buffer->SkippedDepth != 0 || free <= buffer->OpenDepth + 1)
+		{
+			++buffer->SkippedDepth;
+			buffer->DroppedCount.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		++buffer->OpenDepth;
+	}
+	else
+	{
+		if (buffer->SkippedDepth != 0)
+		{
+			--buffer->SkippedDepth;
+			return;
+		}
+		if (buffer->OpenDepth == 0)
+		{
+			return;
+		}
+		--buffer->OpenDepth;
+	}
+
+	// Reads and writes only on the owner thread: the slot is free, reserved when the scope began
+	const uint64_t write = buffer->WriteIndex.load(std::memory_order_relaxed);
+	Event& event = buffer->Events[write % EventCapacity];
+	event.Time = GetTicks();
+	event.Name = name;
+	event.Color = (uint32_t)color;
+	event.Type = type;
+
+	buffer->WriteIndex.store(write + 1, std::memory_order_release);
+}
+
+CpuProfiler::ThreadBuffer* CpuProfiler::RegisterThread()
+{
+	if (!Instance)
+	{
+		return nullptr;
+	}
+
+	MemoryTagScope scope(eMemoryTag::Profiler);
+	ThreadBuffer* buffer = new ThreadBuffer();
+
+	std::lock_guard<std::mutex> lock(Instance->BuffersMutex);
+	Instance->Buffers.push_back(buffer);
+
+	LocalBuffer = buffer;
+	return buffer;
+}
+
+uint64_t CpuProfiler::GetTicks()
+{
+#ifdef USE_RDTSC
+	return __rdtsc();
+#else
+	return (uint64_t)GetSteadyNanoseconds();
+#endif
+}
+
+void CpuProfiler::Drain(ThreadBuffer& buffer, ThreadFrame& frame)
+{
+	frame.Scopes.clear();
+	frame.Nodes.clear();
+
+	// Scopes begun in an earlier frame keep their path in the new tree
+	uint32_t parent = InvalidNode;
+	for (OpenScope& open : buffer.Open)
+	{
+		open.Node = FindOrAddNode(frame, parent, open.Name, open.Color);
+		parent = open.Node;
+	}
+
+	const uint64_t write = buffer.WriteIndex.load(std::memory_order_acquire);
+	uint64_t read = buffer.ReadIndex.load(std::memory_order_relaxed);
+
+	for (; read < write; ++read)
+	{
+		const Event& event = buffer.Events[read % EventCapacity];
+
+		if (event.Type == eEventType::Begin)
+		{
+			const uint32_t node = FindOrAddNode(frame, buffer.Open.empty() ? InvalidNode : buffer.Open.back().Node, event.Name, event.Color);
+			buffer.Open.push_back(OpenScope{ event.Name, event.Color, event.Time, 0, node });
+			continue;
+		}
+
+		// Its begin event was recorded before the profiler got enabled
+		if (buffer.Open.empty())
+		{
+			continue;
+		}
+
+		const OpenScope scope = buffer.Open.back();
+		buffer.Open.pop_back();
+
+		const uint64_t duration = event.Time - scope.Start;
+
+		Node& node = frame.Nodes[scope.Node];
+		++node.CallCount;
+		node.InclusiveTicks += duration;
+		node.ExclusiveTicks += duration - std::min(scope.ChildTicks, duration);
+
+		if (!buffer.Open.empty())
+		{
+			buffer.Open.back().ChildTicks += duration;
+		}
+
+		frame.Scopes.push_back(Scope{ scope.Name, scope.Color, (uint32_t)buffer.Open.size(), scope.Start, event.Time });
+	}
+
+	buffer.ReadIndex.store(read, std::memory_order_release);
+}
+
+uint32_t CpuProfiler::FindOrAddNode(ThreadFrame& frame, uint32_t parent, const char* name, uint32_t color)
+{
+	// Roots are chained from the first node, which is always a root
+	uint32_t child;
+	if (parent != InvalidNode)
+	{
+		child = frame.Nodes[parent].FirstChild;
+	}
+	else
+	{
+		child = frame.Nodes.empty() ? InvalidNode : 0;
+	}
+
+	uint32_t last = InvalidNode;
+	for (; child != InvalidNode; child = frame.Nodes[child].NextSibling)
+	{
+		if (frame.Nodes[child].Name == name)
+		{
+			return child;
+		}
+		last = child;
+	}
+
+	const uint32_t node = (uint32_t)frame.Nodes.size();
+	const uint32_t depth = parent != InvalidNode ? frame.Nodes[parent].Depth + 1 : 0;
+	frame.Nodes.push_back(Node{ name, color, depth, parent, InvalidNode, InvalidNode, 0, 0, 0 });
+
+	if (last != InvalidNode)
+	{
+		frame.Nodes[last].NextSibling = node;
+	}
+	else if (parent != InvalidNode)
+	{
+		frame.Nodes[parent].FirstChild = node;
+	}
+
+	return node;
+}
+
+void CpuProfiler::Calibrate()
+{
+#ifdef USE_RDTSC
+	const uint64_t ticks = GetTicks();
+	const int64_t nanoseconds = GetSteadyNanoseconds();
+
+	// The longer the period, the better the estimation
+	if (ticks > CalibrationTicks && nanoseconds > CalibrationNanoseconds)
+	{
+		MsPerTick = (double)(nanoseconds - CalibrationNanoseconds) * 1e-6 / (double)(ticks - CalibrationTicks);
+	}
+#endif
+}
+
+void CpuProfiler::CaptureFrame(const Frame& frame, uint64_t frameNumber)
+{
+	// Timestamps of the trace start at the first captured frame
+	if (!CaptureStarted)
+	{
+		CaptureStartTicks = frame.Start;
+		CaptureStarted = true;
+	}
+
+	char event[256];
+
+	const auto& toMicroseconds = [this](uint64_t ticks)
+	{
+		return TicksToMs(ticks) * 1000.0;
+	};
+
+	std::snprintf(event, sizeof(event), "{\"name\":\"Frame\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"frame\":%llu}}",
+		toMicroseconds(frame.Start - CaptureStartTicks), toMicroseconds(frame.End - frame.Start), (unsigned int)FramesTrack, (unsigned long long)frameNumber);
+	AppendCaptureEvent(event);
+
+	for (size_t thread = 0; thread < frame.Threads.size(); ++thread)
+	{
+		for (const Scope& scope : frame.Threads[thread].Scopes)
+		{
+			// Scopes begun before the capture are cut at its start
+			const uint64_t start = std::max(scope.Start, CaptureStartTicks);
+			const uint64_t end = std::max(scope.End, start);
+
+			AppendCaptureEvent("{\"name\":");
+			AppendJsonString(CaptureChunk, scope.Name);
+
+			std::snprintf(event, sizeof(event), ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"frame\":%llu}}",
+				toMicroseconds(start - CaptureStartTicks), toMicroseconds(end - start), (unsigned int)thread, (unsigned long long)frameNumber);
+			CaptureChunk += event;
+		}
+	}
+
+	if (CaptureChunk.size() >= CaptureChunkSize)
+	{
+		FlushCaptureChunk();
+	}
+}
+
+void CpuProfiler::AppendCaptureEvent(const char* event)
+{
+	if (!CaptureFirstEvent)
+	{
+		CaptureChunk += ",\n";
+	}
+	CaptureFirstEvent = false;
+
+	CaptureChunk += event;
+}
+
+void CpuProfiler::FlushCaptureChunk()
+{
+	CaptureWriter.Write(std::move(CaptureChunk));
+
+	CaptureChunk = CaptureWriter.AcquireChunk();
+	CaptureChunk.reserve(CaptureChunkSize + 4096);
+}
+
+void CpuProfiler::AppendJsonString(std::string& output, const char* text)
+{
+	output += '"';
+	for (const char* c = text ? text : ""; *c; ++c)
+	{
+		switch (*c)
+		{
+		case '"':
+			output += "\\\"";
+			break;
+		case '\\':
+			output += "\\\\";
+			break;
+		default:
+			// Control characters have no place in a scope name
+			if ((unsigned char)*c >= 0x20)
+			{
+				output += *c;
+			}
+			break;
+		}
+	}
+	output += '"';
+}
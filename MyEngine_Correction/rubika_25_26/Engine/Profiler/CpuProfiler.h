@@ -0,0 +1,209 @@
+#pragma once
+
+#include <Engine/Profiler/TraceWriter.h>
+#include <Engine/Profiler/ProfilerPanel.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+// Portable backend of the PROFILER_EVENT macros, compiled in with USE_PROFILER.
+// Each thread writes its begin/end events in its own ring buffer without locking,
+// the main thread drains them at the end of every frame and builds the scopes and the call tree of each thread.
+// Events are keyed by their name pointer: names must be string literals, format arguments only go to PIX.
+class CpuProfiler final
+{
+public:
+	CpuProfiler();
+	~CpuProfiler();
+
+	CpuProfiler(const CpuProfiler&) = delete;
+	CpuProfiler& operator=(const CpuProfiler&) = delete;
+
+	void Init();
+	void Shut();
+
+	// Main thread, around everything the frame does
+	void BeginFrame();
+	void EndFrame();
+
+	// Any thread. A single relaxed load when the profiler is disabled
+	template <typename... Args>
+	static void BeginEvent(uint64_t color, const char* name, const Args&...);
+	static void EndEvent();
+
+	// Copied, shown instead of the thread index
+	static void SetThreadName(const char* name);
+
+	static bool IsEnabled();
+	static void SetEnabled(bool enabled);
+
+	struct Scope
+	{
+		const char* Name;
+		uint32_t Color;
+		uint32_t Depth;
+		uint64_t Start;
+		uint64_t End;
+	};
+
+	// Calls of a scope merged by their path in the call tree
+	struct Node
+	{
+		const char* Name;
+		uint32_t Color;
+		uint32_t Depth;
+		uint32_t Parent;
+		uint32_t FirstChild;
+		uint32_t NextSibling;
+		uint32_t CallCount;
+		uint64_t InclusiveTicks;
+		uint64_t ExclusiveTicks;
+	};
+
+	struct ThreadFrame
+	{
+		// Ordered by end time, a scope is attributed to the frame where it ends
+		std::vector<Scope> Scopes;
+
+		// Depth first: parents before their children
+		std::vector<Node> Nodes;
+	};
+
+	struct Frame
+	{
+		uint64_t Number;
+		uint64_t Start;
+		uint64_t End;
+
+		// Indexed like the threads
+		std::vector<ThreadFrame> Threads;
+	};
+
+	static constexpr uint32_t InvalidNode = 0xFFFFFFFF;
+
+	// Age 0 is the last ended frame
+	size_t GetFrameCount() const;
+	const Frame& GetFrame(size_t age) const;
+
+	size_t GetThreadCount() const;
+	const char* GetThreadName(size_t thread) const;
+
+	uint64_t GetDroppedEventCount() const;
+
+	double TicksToMs(uint64_t ticks) const;
+
+	// Streams the scopes of the next recorded frames to a Chrome trace event JSON file,
+	// which chrome://tracing and ui.perfetto.dev open. Enables the profiler if it isn't
+	bool StartCapture(const std::filesystem::path& path, uint32_t frameCount);
+	void StopCapture();
+	bool IsCapturing() const;
+	uint32_t GetCaptureFramesLeft() const;
+	size_t GetCaptureWrittenBytes() const;
+
+private:
+	enum class eEventType : uint32_t
+	{
+		Begin,
+		End
+	};
+
+	struct Event
+	{
+		uint64_t Time;
+		const char* Name;
+		uint32_t Color;
+		eEventType Type;
+	};
+
+	struct OpenScope
+	{
+		const char* Name;
+		uint32_t Color;
+		uint64_t Start;
+		uint64_t ChildTicks;
+		uint32_t Node;
+	};
+
+	static constexpr size_t EventCapacity = 16 * 1024;
+	static constexpr size_t HistorySize = 256;
+	static constexpr size_t ThreadNameSize = 32;
+
+	// Single producer, single consumer: the owner thread writes, EndFrame reads
+	struct ThreadBuffer
+	{
+		Event Events[EventCapacity];
+		alignas(64) std::atomic<uint64_t> WriteIndex = 0;
+		alignas(64) std::atomic<uint64_t> ReadIndex = 0;
+		std::atomic<uint64_t> DroppedCount = 0;
+
+		// Only touched by the owner thread. Every open scope keeps a slot free for its end event,
+		// and the end events of dropped begin events are dropped too
+		uint64_t OpenDepth = 0;
+		uint64_t SkippedDepth = 0;
+
+		char Name[ThreadNameSize] = {};
+
+		// Only touched by EndFrame: scopes still open at the end of the last frame
+		std::vector<OpenScope> Open;
+	};
+
+	// Registry of the thread buffers, they live as long as the profiler
+	static CpuProfiler* Instance;
+	static thread_local ThreadBuffer* LocalBuffer;
+	static std::atomic<bool> Enabled;
+
+	// Applied by BeginFrame, when no scope of the main thread is open
+	bool RequestedEnabled;
+
+	mutable std::mutex BuffersMutex;
+	std::vector<ThreadBuffer*> Buffers;
+
+	// Only the frames ended while enabled are recorded
+	std::vector<Frame> History;
+	uint64_t RecordedFrameCount;
+	uint64_t FrameNumber;
+	uint64_t FrameStart;
+
+	// Calibration of the tick counter against the steady clock
+	uint64_t CalibrationTicks;
+	int64_t CalibrationNanoseconds;
+	double MsPerTick;
+
+	// Flushed to the writer every CaptureChunkSize bytes
+	static constexpr size_t CaptureChunkSize = 256 * 1024;
+
+	// Track of the frame slices, after the thread indices
+	static constexpr uint32_t FramesTrack = 1000;
+
+	TraceWriter CaptureWriter;
+	std::string CaptureChunk;
+	uint32_t CaptureFramesLeft;
+	uint64_t CaptureStartTicks;
+	bool CaptureStarted;
+	bool CaptureFirstEvent;
+
+	ProfilerPanel Panel;
+
+	static void PushEvent(eEventType type, uint64_t color, const char* name);
+	static ThreadBuffer* RegisterThread();
+	static uint64_t GetTicks();
+
+	void Drain(ThreadBuffer& buffer, ThreadFrame& frame);
+	uint32_t FindOrAddNode(ThreadFrame& frame, uint32_t parent, const char* name, uint32_t color);
+	void Calibrate();
+
+	void CaptureFrame(const Frame& frame, uint64_t frameNumber);
+	void AppendCaptureEvent(const char* event);
+	void FlushCaptureChunk();
+	static void AppendJsonString(std::string& output, const char* text);
+};
+
+template <typename... Args>
+inline void CpuProfiler::BeginEvent(uint64_t color, const char* name, const Args&...)
+{
+	PushEvent(eEventType::Begin, color, name);
+}
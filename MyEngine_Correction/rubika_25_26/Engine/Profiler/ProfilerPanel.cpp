@@ -0,0 +1,489 @@
+#include "ProfilerPanel.h"
+
+#include <Engine/Profiler/CpuProfiler.h>
+
+#ifdef _USE_IMGUI
+#include <Imgui/imgui.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+#ifdef _USE_IMGUI
+	// Profiler colors are 0xAARRGGBB like PIX, lightened so black scopes stay visible on the dark background
+	ImU32 ToScopeColor(uint32_t color)
+	{
+		const uint32_t r = 64 + ((color >> 16) & 0xFF) * 3 / 4;
+		const uint32_t g = 64 + ((color >> 8) & 0xFF) * 3 / 4;
+		const uint32_t b = 64 + (color & 0xFF) * 3 / 4;
+		return IM_COL32(r, g, b, 255);
+	}
+
+	ImU32 GetTextColor(uint32_t color)
+	{
+		const uint32_t r = 64 + ((color >> 16) & 0xFF) * 3 / 4;
+		const uint32_t g = 64 + ((color >> 8) & 0xFF) * 3 / 4;
+		const uint32_t b = 64 + (color & 0xFF) * 3 / 4;
+		return r * 299 + g * 587 + b * 114 > 150 * 1000 ? IM_COL32(0, 0, 0, 255) : IM_COL32(255, 255, 255, 255);
+	}
+
+	void DrawNode(const CpuProfiler& profiler, const CpuProfiler::ThreadFrame& frame, uint32_t node)
+	{
+		const CpuProfiler::Node& data = frame.Nodes[node];
+
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+
+		ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_DefaultOpen;
+		if (data.FirstChild == CpuProfiler::InvalidNode)
+		{
+			flags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+		}
+
+		const bool open = ImGui::TreeNodeEx((void*)(uintptr_t)node, flags, "%s", data.Name);
+
+		ImGui::TableNextColumn();
+		ImGui::Text("%u", data.CallCount);
+		ImGui::TableNextColumn();
+		ImGui::Text("%.3f", profiler.TicksToMs(data.InclusiveTicks));
+		ImGui::TableNextColumn();
+		ImGui::Text("%.3f", profiler.TicksToMs(data.ExclusiveTicks));
+
+		if (open && data.FirstChild != CpuProfiler::InvalidNode)
+		{
+			for (uint32_t child = data.FirstChild; child != CpuProfiler::InvalidNode; child = frame.Nodes[child].NextSibling)
+			{
+				DrawNode(profiler, frame, child);
+			}
+			ImGui::TreePop();
+		}
+	}
+#endif
+}
+
+ProfilerPanel::ProfilerPanel(CpuProfiler& profiler) : Profiler(profiler), SelectedFrame(0), SelectedFrameNumber(0), SelectedThread(0), StatsWindow(120), CaptureFrameSetting(120), FlameZoom(1.f)
+{}
+
+ProfilerPanel::~ProfilerPanel()
+{}
+
+uint32_t ProfilerPanel::GetCaptureFrameCount() const
+{
+	return (uint32_t)CaptureFrameSetting;
+}
+
+void ProfilerPanel::DrawDebug()
+{
+#ifdef _USE_IMGUI
+#ifndef USE_PROFILER
+	ImGui::Text("Compiled without USE_PROFILER: only the frames are recorded");
+#endif
+
+	bool enabled = CpuProfiler::IsEnabled();
+	if (ImGui::Checkbox("Record", &enabled))
+	{
+		CpuProfiler::SetEnabled(enabled);
+		SelectedFrame = 0;
+		SelectedFrameNumber = 0;
+	}
+	ImGui::SameLine();
+	ImGui::Text("Dropped events: %llu", (unsigned long long)Profiler.GetDroppedEventCount());
+
+	DrawCapture();
+
+	if (Profiler.GetFrameCount() == 0)
+	{
+		return;
+	}
+
+	// The history moves every frame while recording: only the last frame can be followed
+	if (CpuProfiler::IsEnabled())
+	{
+		SelectedFrame = 0;
+		SelectedFrameNumber = 0;
+	}
+	else if (SelectedFrameNumber != 0)
+	{
+		SelectedFrame = FindFrameAge(SelectedFrameNumber);
+	}
+	SelectedFrame = std::clamp(SelectedFrame, 0, (int)Profiler.GetFrameCount() - 1);
+
+	const CpuProfiler::Frame& frame = Profiler.GetFrame(SelectedFrame);
+	SelectedThread = std::clamp(SelectedThread, 0, std::max((int)frame.Threads.size() - 1, 0));
+
+	DrawFrameGraph();
+
+	if (frame.Threads.empty())
+	{
+		return;
+	}
+
+	ImGui::SetNextItemWidth(200.f);
+	const char* threadName = Profiler.GetThreadName(SelectedThread);
+	if (ImGui::BeginCombo("Thread", threadName[0] ? threadName : "Unnamed thread"))
+	{
+		for (int thread = 0; thread < (int)frame.Threads.size(); ++thread)
+		{
+			ImGui::PushID(thread);
+			const char* name = Profiler.GetThreadName(thread);
+			if (ImGui::Selectable(name[0] ? name : "Unnamed thread", thread == SelectedThread))
+			{
+				SelectedThread = thread;
+			}
+			ImGui::PopID();
+		}
+		ImGui::EndCombo();
+	}
+
+	if (ImGui::BeginTabBar("##ProfilerViews"))
+	{
+		if (ImGui::BeginTabItem("Flame"))
+		{
+			DrawFlame();
+			ImGui::EndTabItem();
+		}
+		if (ImGui::BeginTabItem("Tree"))
+		{
+			DrawTree();
+			ImGui::EndTabItem();
+		}
+		if (ImGui::BeginTabItem("Scopes"))
+		{
+			DrawStats();
+			ImGui::EndTabItem();
+		}
+		ImGui::EndTabBar();
+	}
+#endif
+}
+
+void ProfilerPanel::DrawCapture()
+{
+#ifdef _USE_IMGUI
+	if (Profiler.IsCapturing())
+	{
+		ImGui::Text("Capturing: %u frames left, %u KB written", Profiler.GetCaptureFramesLeft(), (unsigned int)(Profiler.GetCaptureWrittenBytes() / 1024));
+		ImGui::SameLine();
+		if (ImGui::Button("Stop capture"))
+		{
+			Profiler.StopCapture();
+		}
+		return;
+	}
+
+	ImGui::SetNextItemWidth(100.f);
+	ImGui::InputInt("Frames to capture", &CaptureFrameSetting);
+	CaptureFrameSetting = std::max(CaptureFrameSetting, 1);
+#endif
+}
+
+void ProfilerPanel::DrawFrameGraph()
+{
+#ifdef _USE_IMGUI
+	// Oldest frame first
+	const size_t frameCount = Profiler.GetFrameCount();
+	FrameTimes.resize(frameCount);
+
+	float maxMs = 0.f;
+	float totalMs = 0.f;
+	for (size_t i = 0; i < frameCount; ++i)
+	{
+		const CpuProfiler::Frame& frame = Profiler.GetFrame(frameCount - 1 - i);
+		const float ms = (float)Profiler.TicksToMs(frame.End - frame.Start);
+		FrameTimes[i] = ms;
+		maxMs = std::max(maxMs, ms);
+		totalMs += ms;
+	}
+
+	const CpuProfiler::Frame& selected = Profiler.GetFrame(SelectedFrame);
+
+	char overlay[128];
+	std::snprintf(overlay, sizeof(overlay), "Frame %llu: %.2f ms (avg %.2f, max %.2f)", (unsigned long long)selected.Number,
+		Profiler.TicksToMs(selected.End - selected.Start), totalMs / (float)frameCount, maxMs);
+
+	// At least the 30 fps budget, so a quiet game doesn't look spiky
+	const float scaleMs = std::max(maxMs, 1000.f / 30.f);
+	ImGui::PlotHistogram("##FrameTimes", FrameTimes.data(), (int)frameCount, 0, overlay, 0.f, scaleMs, ImVec2(-1.f, 80.f));
+
+	const ImVec2 graphMin = ImGui::GetItemRectMin();
+	const ImVec2 graphMax = ImGui::GetItemRectMax();
+
+	// Budget lines of 60 and 30 fps
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	for (const float budgetMs : { 1000.f / 60.f, 1000.f / 30.f })
+	{
+		const float y = graphMax.y - (graphMax.y - graphMin.y) * budgetMs / scaleMs;
+		drawList->AddLine(ImVec2(graphMin.x, y), ImVec2(graphMax.x, y), IM_COL32(255, 255, 0, 96));
+	}
+
+	// Picking a frame stops recording so it stays in the history
+	if (ImGui::IsItemHovered() && ImGui::IsMouseClicked(ImGuiMouseButton_Left))
+	{
+		const float ratio = (ImGui::GetMousePos().x - graphMin.x) / std::max(graphMax.x - graphMin.x, 1.f);
+		const int index = std::clamp((int)(ratio * (float)frameCount), 0, (int)frameCount - 1);
+
+		CpuProfiler::SetEnabled(false);
+		SelectedFrame = (int)frameCount - 1 - index;
+		SelectedFrameNumber = Profiler.GetFrame(SelectedFrame).Number;
+	}
+	ImGui::TextDisabled("Click a frame to inspect it, recording stops until Record is checked again");
+#endif
+}
+
+int ProfilerPanel::FindFrameAge(uint64_t number) const
+{
+	for (size_t age = 0; age < Profiler.GetFrameCount(); ++age)
+	{
+		if (Profiler.GetFrame(age).Number == number)
+		{
+			return (int)age;
+		}
+	}
+
+	// Out of the history already
+	return 0;
+}
+
+void ProfilerPanel::DrawFlame()
+{
+#ifdef _USE_IMGUI
+	const CpuProfiler::Frame& frame = Profiler.GetFrame(SelectedFrame);
+	const CpuProfiler::ThreadFrame& threadFrame = frame.Threads[SelectedThread];
+
+	ImGui::SetNextItemWidth(200.f);
+	ImGui::SliderFloat("Zoom", &FlameZoom, 1.f, 50.f, "%.1fx", ImGuiSliderFlags_Logarithmic);
+
+	uint32_t maxDepth = 0;
+	for (const CpuProfiler::Scope& scope : threadFrame.Scopes)
+	{
+		maxDepth = std::max(maxDepth, scope.Depth);
+	}
+
+	const float rowHeight = ImGui::GetTextLineHeight() + 4.f;
+	const float height = rowHeight * (float)(maxDepth + 1) + ImGui::GetStyle().ScrollbarSize;
+
+	if (!ImGui::BeginChild("##Flame", ImVec2(-1.f, height + 8.f), true, ImGuiWindowFlags_HorizontalScrollbar))
+	{
+		ImGui::EndChild();
+		return;
+	}
+
+	const float width = ImGui::GetContentRegionAvail().x * FlameZoom;
+	const ImVec2 origin = ImGui::GetCursorScreenPos();
+	ImGui::Dummy(ImVec2(width, rowHeight * (float)(maxDepth + 1)));
+
+	const uint64_t frameTicks = std::max<uint64_t>(frame.End - frame.Start, 1);
+	const double pixelsPerTick = (double)width / (double)frameTicks;
+
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	const ImVec2 mouse = ImGui::GetMousePos();
+	const bool hovered = ImGui::IsWindowHovered();
+
+	// Icicle: the outer scopes at the top, their children below
+	for (const CpuProfiler::Scope& scope : threadFrame.Scopes)
+	{
+		// Scopes of other threads may start in an earlier frame
+		const uint64_t start = std::max(scope.Start, frame.Start) - frame.Start;
+		const uint64_t end = std::max(scope.End, frame.Start) - frame.Start;
+
+		const ImVec2 min(origin.x + (float)((double)start * pixelsPerTick), origin.y + rowHeight * (float)scope.Depth);
+		const ImVec2 max(std::max(origin.x + (float)((double)end * pixelsPerTick), min.x + 1.f), min.y + rowHeight - 1.f);
+
+		drawList->AddRectFilled(min, max, ToScopeColor(scope.Color));
+
+		const float textWidth = ImGui::CalcTextSize(scope.Name).x;
+		if (max.x - min.x > textWidth + 4.f)
+		{
+			drawList->AddText(ImVec2(min.x + 2.f, min.y + 2.f), GetTextColor(scope.Color), scope.Name);
+		}
+
+		if (hovered && mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y)
+		{
+			ImGui::BeginTooltip();
+			ImGui::Text("%s", scope.Name);
+			ImGui::Text("%.3f ms", Profiler.TicksToMs(scope.End - scope.Start));
+			ImGui::Text("Starts at %.3f ms", Profiler.TicksToMs(start));
+			ImGui::EndTooltip();
+		}
+	}
+
+	ImGui::EndChild();
+#endif
+}
+
+void ProfilerPanel::DrawTree()
+{
+#ifdef _USE_IMGUI
+	const CpuProfiler::ThreadFrame& threadFrame = Profiler.GetFrame(SelectedFrame).Threads[SelectedThread];
+	if (threadFrame.Nodes.empty())
+	{
+		ImGui::Text("No scope ended on this thread during the frame");
+		return;
+	}
+
+	if (ImGui::BeginTable("##Tree", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable))
+	{
+		ImGui::TableSetupColumn("Scope");
+		ImGui::TableSetupColumn("Calls");
+		ImGui::TableSetupColumn("Inclusive (ms)");
+		ImGui::TableSetupColumn("Exclusive (ms)");
+		ImGui::TableHeadersRow();
+
+		for (uint32_t node = 0; node < threadFrame.Nodes.size(); ++node)
+		{
+			if (threadFrame.Nodes[node].Parent == CpuProfiler::InvalidNode)
+			{
+				DrawNode(Profiler, threadFrame, node);
+			}
+		}
+
+		ImGui::EndTable();
+	}
+#endif
+}
+
+void ProfilerPanel::DrawStats()
+{
+#ifdef _USE_IMGUI
+	ImGui::SetNextItemWidth(200.f);
+	ImGui::SliderInt("Frames", &StatsWindow, 10, 256);
+
+	const size_t frameCount = std::min<size_t>((size_t)StatsWindow, Profiler.GetFrameCount());
+	ComputeStats((size_t)SelectedThread, frameCount);
+
+	ImGui::Text("Inclusive time per frame, over the %u frames before the selected one", (unsigned int)frameCount);
+
+	if (ImGui::BeginTable("##Stats", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable))
+	{
+		ImGui::TableSetupColumn("Scope");
+		ImGui::TableSetupColumn("Frames");
+		ImGui::TableSetupColumn("Calls/frame");
+		ImGui::TableSetupColumn("Min (ms)");
+		ImGui::TableSetupColumn("Avg (ms)");
+		ImGui::TableSetupColumn("Max (ms)");
+		ImGui::TableSetupColumn("p99 (ms)");
+		ImGui::TableHeadersRow();
+
+		for (const ScopeStats& stats : Stats)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextColored(ImGui::ColorConvertU32ToFloat4(ToScopeColor(stats.Color)), "%s", stats.Name);
+			ImGui::TableNextColumn();
+			ImGui::Text("%u", stats.FrameCount);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", (float)stats.CallCount / (float)std::max(stats.FrameCount, 1u));
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", stats.MinMs);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", stats.AverageMs);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", stats.MaxMs);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", stats.P99Ms);
+		}
+
+		ImGui::EndTable();
+	}
+#endif
+}
+
+void ProfilerPanel::ComputeStats(size_t thread, size_t frameCount)
+{
+	Stats.clear();
+	Samples.clear();
+
+	const size_t availableFrames = Profiler.GetFrameCount() - (size_t)SelectedFrame;
+	frameCount = std::min(frameCount, availableFrames);
+
+	for (size_t age = 0; age < frameCount; ++age)
+	{
+		const CpuProfiler::Frame& frame = Profiler.GetFrame((size_t)SelectedFrame + age);
+		if (thread >= frame.Threads.size())
+		{
+			continue;
+		}
+
+		// A scope called from several places of the tree is summed in the frame
+		std::fill(FrameTotals.begin(), FrameTotals.end(), 0.f);
+		std::fill(FrameCalls.begin(), FrameCalls.end(), 0u);
+
+		for (const CpuProfiler::Node& node : frame.Threads[thread].Nodes)
+		{
+			if (node.CallCount == 0)
+			{
+				continue;
+			}
+
+			const uint32_t stats = FindOrAddStats(node.Name, node.Color);
+			FrameTotals[stats] += (float)Profiler.TicksToMs(node.InclusiveTicks);
+			FrameCalls[stats] += node.CallCount;
+		}
+
+		for (uint32_t stats = 0; stats < Stats.size(); ++stats)
+		{
+			if (FrameCalls[stats] != 0)
+			{
+				Samples.push_back(ScopeSample{ stats, FrameTotals[stats] });
+				Stats[stats].CallCount += FrameCalls[stats];
+			}
+		}
+	}
+
+	// Grouped by scope and sorted by time: the percentiles are read directly
+	std::sort(Samples.begin(), Samples.end(), [](const ScopeSample& a, const ScopeSample& b)
+	{
+		return a.Stats != b.Stats ? a.Stats < b.Stats : a.Ms < b.Ms;
+	});
+
+	for (size_t first = 0; first < Samples.size();)
+	{
+		size_t last = first;
+		float total = 0.f;
+		while (last < Samples.size() && Samples[last].Stats == Samples[first].Stats)
+		{
+			total += Samples[last].Ms;
+			++last;
+		}
+
+		const size_t count = last - first;
+		ScopeStats& stats = Stats[Samples[first].Stats];
+		stats.FrameCount = (uint32_t)count;
+		stats.MinMs = Samples[first].Ms;
+		stats.MaxMs = Samples[last - 1].Ms;
+		stats.AverageMs = total / (float)count;
+		stats.P99Ms = Samples[first + std::min(count - 1, (size_t)std::ceil((double)count * 0.99) - 1)].Ms;
+
+		first = last;
+	}
+
+	// The most expensive scopes first
+	std::sort(Stats.begin(), Stats.end(), [](const ScopeStats& a, const ScopeStats& b)
+	{
+		return a.AverageMs > b.AverageMs;
+	});
+}
+
+uint32_t ProfilerPanel::FindOrAddStats(const char* name, uint32_t color)
+{
+	// A few dozens of scopes at most, a linear search beats hashing
+	for (uint32_t stats = 0; stats < Stats.size(); ++stats)
+	{
+		if (Stats[stats].Name == name)
+		{
+			return stats;
+		}
+	}
+
+	Stats.push_back(ScopeStats{ name, color, 0, 0, 0.f, 0.f, 0.f, 0.f });
+	if (FrameTotals.size() < Stats.size())
+	{
+		FrameTotals.resize(Stats.size(), 0.f);
+		FrameCalls.resize(Stats.size(), 0u);
+	}
+
+	return (uint32_t)(Stats.size() - 1);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Engine/Debug/DebugMgr.h>
+
+#include <vector>
+#include <cstdint>
+
+class CpuProfiler;
+
+// Debug tab of the CpuProfiler: frame time graph, flame view of a frame, call tree,
+// and min/avg/max/p99 of every scope over the last frames.
+// Everything is computed from the profiler history when drawn, in buffers kept from one frame to the next.
+class ProfilerPanel final : public IDebugable
+{
+public:
+	ProfilerPanel(CpuProfiler& profiler);
+	~ProfilerPanel();
+
+	uint32_t GetCaptureFrameCount() const;
+
+	virtual void DrawDebug() override;
+
+private:
+	struct ScopeStats
+	{
+		const char* Name;
+		uint32_t Color;
+		uint32_t FrameCount;
+		uint32_t CallCount;
+		float MinMs;
+		float AverageMs;
+		float MaxMs;
+		float P99Ms;
+	};
+
+	struct ScopeSample
+	{
+		uint32_t Stats;
+		float Ms;
+	};
+
+	CpuProfiler& Profiler;
+
+	// Age of the frame shown by the flame view and the tree, 0 is the last one
+	int SelectedFrame;
+	// Number of the frame picked in the graph, 0 to follow the last one. Resolved to an age every draw:
+	// recording only stops at the next BeginFrame, so the history still moves once after the click
+	uint64_t SelectedFrameNumber;
+	int SelectedThread;
+	int StatsWindow;
+	int CaptureFrameSetting;
+	float FlameZoom;
+
+	std::vector<float> FrameTimes;
+	std::vector<ScopeStats> Stats;
+	std::vector<ScopeSample> Samples;
+	std::vector<float> FrameTotals;
+	std::vector<uint32_t> FrameCalls;
+
+	int FindFrameAge(uint64_t number) const;
+
+	void DrawCapture();
+	void DrawFrameGraph();
+	void DrawFlame();
+	void DrawTree();
+	void DrawStats();
+
+	void ComputeStats(size_t thread, size_t frameCount);
+	uint32_t FindOrAddStats(const char* name, uint32_t color);
+};
@@ -0,0 +1,131 @@
+#include "TraceWriter.h"
+
+TraceWriter::TraceWriter() : StopThread(false), Failed(false), WrittenBytes(0)
+{}
+
+TraceWriter::~TraceWriter()
+{
+	Close();
+}
+
+bool TraceWriter::Open(const std::filesystem::path& path)
+{
+	Close();
+
+	std::error_code error;
+	if (path.has_parent_path())
+	{
+		std::filesystem::create_directories(path.parent_path(), error);
+	}
+
+	File.open(path, std::ios::binary | std::ios::trunc);
+	if (!File.is_open())
+	{
+		return false;
+	}
+
+	Path = path;
+	Failed = false;
+	WrittenBytes = 0;
+	StopThread = false;
+	Thread = std::thread(&TraceWriter::ThreadLoop, this);
+
+	return true;
+}
+
+void TraceWriter::Close()
+{
+	if (!Thread.joinable())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(QueueMutex);
+		StopThread = true;
+	}
+	QueueCondition.notify_one();
+
+	Thread.join();
+	File.close();
+}
+
+bool TraceWriter::IsOpen() const
+{
+	return Thread.joinable();
+}
+
+bool TraceWriter::HasFailed() const
+{
+	return Failed;
+}
+
+size_t TraceWriter::GetWrittenBytes() const
+{
+	return WrittenBytes;
+}
+
+const std::filesystem::path& TraceWriter::GetPath() const
+{
+	return Path;
+}
+
+std::string TraceWriter::AcquireChunk()
+{
+	std::lock_guard<std::mutex> lock(QueueMutex);
+	if (FreeChunks.empty())
+	{
+		return std::string();
+	}
+
+	std::string chunk = std::move(FreeChunks.back());
+	FreeChunks.pop_back();
+	return chunk;
+}
+
+void TraceWriter::Write(std::string&& chunk)
+{
+	if (chunk.empty())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(QueueMutex);
+		QueuedChunks.push_back(std::move(chunk));
+	}
+	QueueCondition.notify_one();
+}
+
+void TraceWriter::ThreadLoop()
+{
+	while (true)
+	{
+		std::string chunk;
+		{
+			std::unique_lock<std::mutex> lock(QueueMutex);
+			QueueCondition.wait(lock, [this]() { return StopThread || !QueuedChunks.empty(); });
+
+			// Stops once everything queued is written
+			if (QueuedChunks.empty())
+			{
+				return;
+			}
+
+			chunk = std::move(QueuedChunks.front());
+			QueuedChunks.pop_front();
+		}
+
+		File.write(chunk.data(), (std::streamsize)chunk.size());
+		if (!File)
+		{
+			Failed = true;
+		}
+		WrittenBytes += chunk.size();
+
+		chunk.clear();
+
+		std::lock_guard<std::mutex> lock(QueueMutex);
+		FreeChunks.push_back(std::move(chunk));
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// Writes text chunks to a file from its own thread, so the frame never waits on the disk.
+// Chunks are given back once written and can be reused to avoid allocating while a capture runs.
+class TraceWriter
+{
+public:
+	TraceWriter();
+	~TraceWriter();
+
+	TraceWriter(const TraceWriter&) = delete;
+	TraceWriter& operator=(const TraceWriter&) = delete;
+
+	bool Open(const std::filesystem::path& path);
+
+	// Writes what is still queued, then closes the file
+	void Close();
+
+	bool IsOpen() const;
+	bool HasFailed() const;
+	size_t GetWrittenBytes() const;
+	const std::filesystem::path& GetPath() const;
+
+	// Empty, keeping the capacity of an already written chunk when there is one
+	std::string AcquireChunk();
+	void Write(std::string&& chunk);
+
+private:
+	std::filesystem::path Path;
+	std::ofstream File;
+
+	std::thread Thread;
+	std::mutex QueueMutex;
+	std::condition_variable QueueCondition;
+	std::deque<std::string> QueuedChunks;
+	std::vector<std::string> FreeChunks;
+	bool StopThread;
+
+	std::atomic<bool> Failed;
+	std::atomic<size_t> WrittenBytes;
+
+	void ThreadLoop();
+};
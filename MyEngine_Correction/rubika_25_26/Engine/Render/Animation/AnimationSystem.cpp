@@ -0,0 +1,218 @@
+#include "AnimationSystem.h"
+
+#include <Engine/Globals.h>
+#include <Engine/Simd.h>
+#include <Engine/Render/Drawable/Sprite/Sprite.h>
+#include <Engine/Render/Ressource/TextureMgr.h>
+
+#ifdef _USE_IMGUI
+#include <Imgui/imgui.h>
+#endif
+
+#include <algorithm>
+#include <assert.h>
+
+AnimationSystem::AnimationSystem() : Count(0), LastChangedCount(0), UseSimd(true)
+{}
+
+AnimationSystem::~AnimationSystem()
+{}
+
+void AnimationSystem::Init()
+{
+	gData.DebugMgr->RegisterDebugableWindow("AnimationSystem", this);
+}
+
+void AnimationSystem::Shut()
+{
+	gData.DebugMgr->UnregisterDebugableWindow("AnimationSystem");
+}
+
+uint32_t AnimationSystem::Register(Sprite& sprite)
+{
+	const size_t slot = Count;
+	Resize(Count + 1);
+
+	Sprites[slot] = &sprite;
+	return (uint32_t)slot;
+}
+
+void AnimationSystem::Unregister(uint32_t slot)
+{
+	assert(slot < Count);
+
+	// Keep the arrays dense: the last sprite takes the freed slot
+	const size_t last = Count - 1;
+	if (slot != last)
+	{
+		Times[slot] = Times[last];
+		Intervals[slot] = Intervals[last];
+		Frames[slot] = Frames[last];
+		FrameCounts[slot] = FrameCounts[last];
+		PlayingMasks[slot] = PlayingMasks[last];
+		Sprites[slot] = Sprites[last];
+		Sprites[slot]->AnimationSlot = slot;
+	}
+
+	Resize(last);
+}
+
+void AnimationSystem::SetAnimation(uint32_t slot, const AnimationData& animation)
+{
+	assert(slot < Count);
+	Intervals[slot] = animation.TimeBetweenAnimationInS;
+	FrameCounts[slot] = animation.AnimationSpriteCount;
+}
+
+void AnimationSystem::SetPlaying(uint32_t slot, bool play)
+{
+	assert(slot < Count);
+	PlayingMasks[slot] = play ? -1 : 0;
+}
+
+void AnimationSystem::Reset(uint32_t slot)
+{
+	assert(slot < Count);
+	Times[slot] = 0.f;
+	Frames[slot] = 0;
+}
+
+int AnimationSystem::GetFrame(uint32_t slot) const
+{
+	assert(slot < Count);
+	return Frames[slot];
+}
+
+void AnimationSystem::Update(float deltaTime)
+{
+	LastChangedCount = 0;
+
+#ifdef USE_SSE2
+	if (UseSimd)
+	{
+		UpdateSimd(deltaTime);
+		return;
+	}
+#endif
+
+	UpdateScalar(deltaTime, 0, Count);
+}
+
+void AnimationSystem::DrawDebug()
+{
+#ifdef _USE_IMGUI
+	ImGui::Text("Animated sprites: %u", (unsigned int)Count);
+	ImGui::Text("Frames changed: %u", LastChangedCount);
+
+#ifdef USE_SSE2
+	ImGui::Checkbox("SSE2", &UseSimd);
+#else
+	ImGui::Text("SSE2: not available");
+#endif
+#endif
+}
+
+void AnimationSystem::Resize(size_t count)
+{
+	// Padding lanes never play, so the SIMD loop can run on whole groups of 4
+	const size_t paddedCount = (count + LaneCount - 1) / LaneCount * LaneCount;
+	const size_t previousCount = Count;
+
+	Times.resize(paddedCount, 0.f);
+	Intervals.resize(paddedCount, 0.f);
+	Frames.resize(paddedCount, 0);
+	FrameCounts.resize(paddedCount, 1);
+	PlayingMasks.resize(paddedCount, 0);
+	Sprites.resize(paddedCount, nullptr);
+
+	for (size_t i = count; i < std::min(previousCount, paddedCount); ++i)
+	{
+		Times[i] = 0.f;
+		Intervals[i] = 0.f;
+		Frames[i] = 0;
+		FrameCounts[i] = 1;
+		PlayingMasks[i] = 0;
+		Sprites[i] = nullptr;
+	}
+
+	Count = count;
+}
+
+void AnimationSystem::EmitFrame(size_t slot)
+{
+	Sprites[slot]->ApplyFrame(Frames[slot]);
+	++LastChangedCount;
+}
+
+void AnimationSystem::UpdateScalar(float deltaTime, size_t first, size_t last)
+{
+	for (size_t i = first; i < last; ++i)
+	{
+		if (!PlayingMasks[i])
+		{
+			continue;
+		}
+
+		const int32_t previousFrame = Frames[i];
+
+		Times[i] += deltaTime;
+		if (Times[i] >= Intervals[i])
+		{
+			++Frames[i];
+			if (Frames[i] >= FrameCounts[i])
+			{
+				Frames[i] = 0;
+			}
+			Times[i] = 0.f;
+		}
+
+		if (Frames[i] != previousFrame)
+		{
+			EmitFrame(i);
+		}
+	}
+}
+
+void AnimationSystem::UpdateSimd(float deltaTime)
+{
+#ifdef USE_SSE2
+	const __m128 delta = _mm_set1_ps(deltaTime);
+
+	for (size_t i = 0; i < Count; i += LaneCount)
+	{
+		const __m128i playing = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&PlayingMasks[i]));
+		const __m128 playingMask = _mm_castsi128_ps(playing);
+
+		__m128 time = _mm_loadu_ps(&Times[i]);
+		time = _mm_add_ps(time, _mm_and_ps(delta, playingMask));
+
+		// Lanes reaching their interval move to the next frame and restart their timer
+		const __m128 step = _mm_and_ps(_mm_cmpge_ps(time, _mm_loadu_ps(&Intervals[i])), playingMask);
+		time = _mm_andnot_ps(step, time);
+
+		const __m128i frame = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&Frames[i]));
+		__m128i nextFrame = _mm_sub_epi32(frame, _mm_castps_si128(step));
+		const __m128i frameCount = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&FrameCounts[i]));
+		nextFrame = _mm_and_si128(nextFrame, _mm_cmplt_epi32(nextFrame, frameCount));
+
+		_mm_storeu_ps(&Times[i], time);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&Frames[i]), nextFrame);
+
+		const int changed = ~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(nextFrame, frame))) & 0xF;
+		if (!changed)
+		{
+			continue;
+		}
+
+		for (size_t lane = 0; lane < LaneCount; ++lane)
+		{
+			if (changed & (1 << lane))
+			{
+				EmitFrame(i + lane);
+			}
+		}
+	}
+#else
+	UpdateScalar(deltaTime, 0, Count);
+#endif
+}
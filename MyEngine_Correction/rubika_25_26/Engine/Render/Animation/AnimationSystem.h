@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Engine/Debug/DebugMgr.h>
+
+#include <vector>
+#include <cstdint>
+
+class Sprite;
+struct AnimationData;
+
+// Advances the animation of every registered sprite in one pass.
+// States are kept in parallel arrays padded to 4 lanes and stepped 4 at a time with SSE2 when available.
+// Only the sprites whose frame changed get a new texture rect.
+class AnimationSystem final : public IDebugable
+{
+public:
+	AnimationSystem();
+	~AnimationSystem();
+
+	void Init();
+	void Shut();
+
+	static constexpr uint32_t InvalidSlot = 0xFFFFFFFF;
+
+	uint32_t Register(Sprite& sprite);
+	void Unregister(uint32_t slot);
+
+	// Keeps the current frame and time, like switching animation always did
+	void SetAnimation(uint32_t slot, const AnimationData& animation);
+	void SetPlaying(uint32_t slot, bool play);
+	void Reset(uint32_t slot);
+	int GetFrame(uint32_t slot) const;
+
+	void Update(float deltaTime);
+
+	virtual void DrawDebug() override;
+
+private:
+	static constexpr size_t LaneCount = 4;
+
+	std::vector<float> Times;
+	std::vector<float> Intervals;
+	std::vector<int32_t> Frames;
+	std::vector<int32_t> FrameCounts;
+	std::vector<int32_t> PlayingMasks;
+	std::vector<Sprite*> Sprites;
+
+	size_t Count;
+
+	unsigned int LastChangedCount;
+	bool UseSimd;
+
+	void Resize(size_t count);
+	void EmitFrame(size_t slot);
+	void UpdateScalar(float deltaTime, size_t first, size_t last);
+	void UpdateSimd(float deltaTime);
+};
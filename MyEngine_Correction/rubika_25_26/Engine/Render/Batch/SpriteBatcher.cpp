@@ -0,0 +1,253 @@
+#include "SpriteBatcher.h"
+
+#include <Engine/Globals.h>
+#include <Engine/Render/Drawable/IDrawable.h>
+#include <Engine/Memory/FrameArena.h>
+
+#include <SFML/Graphics/RenderTarget.hpp>
+
+#ifdef _USE_IMGUI
+#include <Imgui/imgui.h>
+#endif
+
+#include <algorithm>
+
+namespace
+{
+	// Two triangles per quad
+	constexpr size_t VerticesPerQuad = 6;
+
+	void WriteQuad(sf::Vertex* vertices, const Affine2D& transform, const DrawableQuad& quad)
+	{
+		const sf::Vector2f topLeft = transform.TransformPoint(sf::Vector2f(0.f, 0.f));
+		const sf::Vector2f topRight = transform.TransformPoint(sf::Vector2f(quad.Size.x, 0.f));
+		const sf::Vector2f bottomLeft = transform.TransformPoint(sf::Vector2f(0.f, quad.Size.y));
+		const sf::Vector2f bottomRight = transform.TransformPoint(quad.Size);
+
+		// A negative texture rect size flips the quad
+		const float left = (float)quad.TextureRect.position.x;
+		const float top = (float)quad.TextureRect.position.y;
+		const float right = left + (float)quad.TextureRect.size.x;
+		const float bottom = top + (float)quad.TextureRect.size.y;
+
+		vertices[0] = sf::Vertex{ topLeft, quad.Color, sf::Vector2f(left, top) };
+		vertices[1] = sf::Vertex{ topRight, quad.Color, sf::Vector2f(right, top) };
+		vertices[2] = sf::Vertex{ bottomLeft, quad.Color, sf::Vector2f(left, bottom) };
+		vertices[3] = sf::Vertex{ bottomLeft, quad.Color, sf::Vector2f(left, bottom) };
+		vertices[4] = sf::Vertex{ topRight, quad.Color, sf::Vector2f(right, top) };
+		vertices[5] = sf::Vertex{ bottomRight, quad.Color, sf::Vector2f(right, bottom) };
+	}
+}
+
+SpriteBatcher::SpriteBatcher(): StaticBuffer(sf::PrimitiveType::Triangles, sf::VertexBuffer::Usage::Static), StaticGeometryDirty(false), UseStaticBuffer(false),
+LastDrawCallCount(0), LastQuadCount(0), StaticRebuildCount(0)
+{}
+
+SpriteBatcher::~SpriteBatcher()
+{}
+
+void SpriteBatcher::Init()
+{
+	gData.DebugMgr->RegisterDebugableWindow("SpriteBatcher", this);
+}
+
+void SpriteBatcher::Shut()
+{
+	gData.DebugMgr->UnregisterDebugableWindow("SpriteBatcher");
+}
+
+void SpriteBatcher::Begin()
+{
+	Items.clear();
+	Transforms.clear();
+	Quads.clear();
+}
+
+void SpriteBatcher::Submit(const IDrawable& drawable)
+{
+	if (!drawable.IsVisible() || drawable.IsStatic())
+	{
+		return;
+	}
+
+	DrawableQuad& quad = Quads.emplace_back();
+	if (!drawable.GetQuad(quad))
+	{
+		Quads.pop_back();
+		return;
+	}
+
+	Items.push_back(BatchItem{ drawable.GetLayer(), quad.Texture, (unsigned int)Transforms.size() });
+	Transforms.push_back(drawable.GetWorldTransform());
+}
+
+void SpriteBatcher::Flush(sf::RenderTarget& target)
+{
+	if (StaticGeometryDirty)
+	{
+		RebuildStaticGeometry();
+	}
+
+	BuildBatches(Items, Transforms, Quads, Vertices, Batches);
+
+	LastDrawCallCount = 0;
+	LastQuadCount = (unsigned int)(Vertices.size() + StaticVertices.size()) / VerticesPerQuad;
+
+	// Merge the static and dynamic batches by layer, static geometry first
+	size_t staticIndex = 0;
+	size_t dynamicIndex = 0;
+	while (staticIndex < StaticBatches.size() || dynamicIndex < Batches.size())
+	{
+		if (dynamicIndex == Batches.size() || (staticIndex < StaticBatches.size() && StaticBatches[staticIndex].Layer <= Batches[dynamicIndex].Layer))
+		{
+			DrawStaticBatch(target, StaticBatches[staticIndex++]);
+			continue;
+		}
+
+		// Consecutive dynamic batches of different layers can still share a draw call
+		const Batch& first = Batches[dynamicIndex];
+		size_t vertexCount = first.VertexCount;
+		++dynamicIndex;
+
+		while (dynamicIndex < Batches.size() && Batches[dynamicIndex].Texture == first.Texture
+			&& (staticIndex == StaticBatches.size() || StaticBatches[staticIndex].Layer > Batches[dynamicIndex].Layer))
+		{
+			vertexCount += Batches[dynamicIndex].VertexCount;
+			++dynamicIndex;
+		}
+
+		sf::RenderStates states = sf::RenderStates::Default;
+		states.texture = first.Texture;
+
+		target.draw(&Vertices[first.FirstVertex], vertexCount, sf::PrimitiveType::Triangles, states);
+		++LastDrawCallCount;
+	}
+}
+
+void SpriteBatcher::RegisterStatic(const IDrawable* drawable)
+{
+	if (std::find(StaticDrawables.begin(), StaticDrawables.end(), drawable) != StaticDrawables.end())
+	{
+		return;
+	}
+
+	StaticDrawables.push_back(drawable);
+	StaticGeometryDirty = true;
+}
+
+void SpriteBatcher::UnregisterStatic(const IDrawable* drawable)
+{
+	// Keep the registration order, it is used to sort quads of the same layer and texture
+	const auto& it = std::find(StaticDrawables.begin(), StaticDrawables.end(), drawable);
+	if (it == StaticDrawables.end())
+	{
+		return;
+	}
+
+	StaticDrawables.erase(it);
+	StaticGeometryDirty = true;
+}
+
+void SpriteBatcher::InvalidateStaticGeometry()
+{
+	StaticGeometryDirty = true;
+}
+
+void SpriteBatcher::DrawDebug()
+{
+#ifdef _USE_IMGUI
+	ImGui::Text("Quads: %u", LastQuadCount);
+	ImGui::Text("Draw calls: %u", LastDrawCallCount);
+	ImGui::Separator();
+	ImGui::Text("Static drawables: %u", (unsigned int)StaticDrawables.size());
+	ImGui::Text("Static batches: %u", (unsigned int)StaticBatches.size());
+	ImGui::Text("Static rebuilds: %u", StaticRebuildCount);
+	ImGui::Text("Static vertex buffer: %s", UseStaticBuffer ? "Yes" : "No");
+#endif
+}
+
+void SpriteBatcher::BuildBatches(std::span<BatchItem> items, std::span<const Affine2D> transforms, std::span<const DrawableQuad> quads, std::vector<sf::Vertex>& vertices, std::vector<Batch>& batches) const
+{
+	std::sort(items.begin(), items.end(), [](const BatchItem& a, const BatchItem& b)
+	{
+		if (a.Layer != b.Layer)
+		{
+			return a.Layer < b.Layer;
+		}
+
+		if (a.Texture != b.Texture)
+		{
+			return a.Texture < b.Texture;
+		}
+
+		return a.Order < b.Order;
+	});
+
+	vertices.resize(items.size() * VerticesPerQuad);
+	batches.clear();
+
+	for (size_t i = 0; i < items.size(); ++i)
+	{
+		const BatchItem& item = items[i];
+		WriteQuad(&vertices[i * VerticesPerQuad], transforms[item.Order], quads[item.Order]);
+
+		if (batches.empty() || batches.back().Layer != item.Layer || batches.back().Texture != item.Texture)
+		{
+			batches.push_back(Batch{ item.Layer, item.Texture, i * VerticesPerQuad, 0 });
+		}
+
+		batches.back().VertexCount += VerticesPerQuad;
+	}
+}
+
+void SpriteBatcher::RebuildStaticGeometry()
+{
+	// Scratch data, gone with the frame
+	FrameArena& arena = *gData.FrameArena;
+	FrameVector<BatchItem> items(arena);
+	FrameVector<Affine2D> transforms(arena);
+	FrameVector<DrawableQuad> quads(arena);
+
+	items.reserve(StaticDrawables.size());
+	transforms.reserve(StaticDrawables.size());
+	quads.reserve(StaticDrawables.size());
+
+	for (const IDrawable* drawable : StaticDrawables)
+	{
+		DrawableQuad quad;
+		if (!drawable->IsVisible() || !drawable->GetQuad(quad))
+		{
+			continue;
+		}
+
+		items.push_back(BatchItem{ drawable->GetLayer(), quad.Texture, (unsigned int)transforms.size() });
+		transforms.push_back(drawable->GetWorldTransform());
+		quads.push_back(quad);
+	}
+
+	BuildBatches(items, transforms, quads, StaticVertices, StaticBatches);
+
+	UseStaticBuffer = sf::VertexBuffer::isAvailable() && !StaticVertices.empty()
+		&& StaticBuffer.create(StaticVertices.size())
+		&& StaticBuffer.update(StaticVertices.data());
+
+	StaticGeometryDirty = false;
+	++StaticRebuildCount;
+}
+
+void SpriteBatcher::DrawStaticBatch(sf::RenderTarget& target, const Batch& batch)
+{
+	sf::RenderStates states = sf::RenderStates::Default;
+	states.texture = batch.Texture;
+
+	if (UseStaticBuffer)
+	{
+		target.draw(StaticBuffer, batch.FirstVertex, batch.VertexCount, states);
+	}
+	else
+	{
+		target.draw(&StaticVertices[batch.FirstVertex], batch.VertexCount, sf::PrimitiveType::Triangles, states);
+	}
+
+	++LastDrawCallCount;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <Engine/Debug/DebugMgr.h>
+#include <Engine/Math/Affine2D.h>
+
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/VertexBuffer.hpp>
+
+#include <span>
+#include <vector>
+
+namespace sf
+{
+	class RenderTarget;
+	class Texture;
+}
+
+class IDrawable;
+struct DrawableQuad;
+
+// Gathers the drawables of a frame and draws them with one draw call per texture.
+// Submitted quads are sorted by layer then by texture, the submission order is kept otherwise.
+// Static drawables are registered once and baked in a vertex buffer rebuilt only when they change.
+class SpriteBatcher final : public IDebugable
+{
+public:
+	SpriteBatcher();
+	~SpriteBatcher();
+
+	void Init();
+	void Shut();
+
+	void Begin();
+	void Submit(const IDrawable& drawable);
+	void Flush(sf::RenderTarget& target);
+
+	void RegisterStatic(const IDrawable* drawable);
+	void UnregisterStatic(const IDrawable* drawable);
+	void InvalidateStaticGeometry();
+
+	virtual void DrawDebug() override;
+
+private:
+
+	struct BatchItem
+	{
+		int Layer;
+		const sf::Texture* Texture;
+		unsigned int Order;
+	};
+
+	// Range of vertices sharing a layer and a texture
+	struct Batch
+	{
+		int Layer;
+		const sf::Texture* Texture;
+		size_t FirstVertex;
+		size_t VertexCount;
+	};
+
+	std::vector<BatchItem> Items;
+	std::vector<Affine2D> Transforms;
+	std::vector<DrawableQuad> Quads;
+
+	std::vector<sf::Vertex> Vertices;
+	std::vector<Batch> Batches;
+
+	std::vector<const IDrawable*> StaticDrawables;
+	std::vector<sf::Vertex> StaticVertices;
+	std::vector<Batch> StaticBatches;
+	sf::VertexBuffer StaticBuffer;
+	bool StaticGeometryDirty;
+	bool UseStaticBuffer;
+
+	unsigned int LastDrawCallCount;
+	unsigned int LastQuadCount;
+	unsigned int StaticRebuildCount;
+
+	void BuildBatches(std::span<BatchItem> items, std::span<const Affine2D> transforms, std::span<const DrawableQuad> quads, std::vector<sf::Vertex>& vertices, std::vector<Batch>& batches) const;
+	void RebuildStaticGeometry();
+	void DrawStaticBatch(sf::RenderTarget& target, const Batch& batch);
+};
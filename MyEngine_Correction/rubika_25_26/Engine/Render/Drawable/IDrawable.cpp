@@ -1,35 +1,108 @@
 #include "IDrawable.h"
 
-IDrawable::IDrawable(): Visible(true), WorldTransform(sf::Transform::Identity), Drawable(nullptr)
+#include <Engine/Globals.h>
+#include <Engine/Render/Batch/SpriteBatcher.h>
+
+#include <algorithm>
+
+IDrawable::IDrawable(): Visible(true), Static(false), Layer(0), WorldTransform(Affine2D::Identity), Drawable(nullptr), WorldBounds(), BoundsDirty(true), BoundsVersion(1)
 {}
 
 IDrawable::~IDrawable()
+{}
+
+bool IDrawable::IsVisible() const
 {
-	if (Drawable)
+	return Visible;
+}
+
+void IDrawable::SetVisibility(bool visible)
+{
+	if (Visible != visible)
 	{
-		delete Drawable;
-		Drawable = nullptr;
+		Visible = visible;
+		InvalidateBounds();
+		InvalidateStaticGeometry();
+		OnVisibilityChanged();
 	}
 }
 
-bool IDrawable::IsVisible() const
+int IDrawable::GetLayer() const
 {
-	return Visible;
+	return Layer;
 }
 
-void IDrawable::SetVisibility(bool visible)
+void IDrawable::SetLayer(int layer)
 {
-	Visible = visible;
+	Layer = layer;
+	InvalidateStaticGeometry();
 }
 
-const sf::Transform& IDrawable::GetWorldTransform() const
+bool IDrawable::IsStatic() const
+{
+	return Static;
+}
+
+void IDrawable::SetStatic(bool isStatic)
+{
+	Static = isStatic;
+}
+
+const Affine2D& IDrawable::GetWorldTransform() const
 {
 	return WorldTransform;
 }
 
-void IDrawable::SetWorldTransform(const sf::Transform& transform)
+void IDrawable::SetWorldTransform(const Affine2D& transform)
 {
+	if (Static && WorldTransform != transform)
+	{
+		InvalidateStaticGeometry();
+	}
+
 	WorldTransform = transform;
+	InvalidateBounds();
+}
+
+const sf::FloatRect& IDrawable::GetWorldBounds() const
+{
+	if (!BoundsDirty)
+	{
+		return WorldBounds;
+	}
+
+	DrawableQuad quad;
+	if (!GetQuad(quad))
+	{
+		quad.Size = sf::Vector2f();
+	}
+
+	const sf::Vector2f corners[4] =
+	{
+		WorldTransform.TransformPoint(sf::Vector2f(0.f, 0.f)),
+		WorldTransform.TransformPoint(sf::Vector2f(quad.Size.x, 0.f)),
+		WorldTransform.TransformPoint(sf::Vector2f(0.f, quad.Size.y)),
+		WorldTransform.TransformPoint(quad.Size)
+	};
+
+	sf::Vector2f min = corners[0];
+	sf::Vector2f max = corners[0];
+	for (const sf::Vector2f& corner : corners)
+	{
+		min.x = std::min(min.x, corner.x);
+		min.y = std::min(min.y, corner.y);
+		max.x = std::max(max.x, corner.x);
+		max.y = std::max(max.y, corner.y);
+	}
+
+	WorldBounds = sf::FloatRect(min, max - min);
+	BoundsDirty = false;
+	return WorldBounds;
+}
+
+uint32_t IDrawable::GetBoundsVersion() const
+{
+	return BoundsVersion;
 }
 
 void IDrawable::Draw(sf::RenderWindow& window) const
@@ -40,7 +113,29 @@ void IDrawable::Draw(sf::RenderWindow& window) const
 	}
 
 	sf::RenderStates states = sf::RenderStates::Default;
-	states.transform = WorldTransform;
+	states.transform = WorldTransform.ToSfml();
 
 	window.draw(*Drawable, states);
 }
+
+void IDrawable::OnVisibilityChanged()
+{}
+
+void IDrawable::InvalidateBounds()
+{
+	BoundsDirty = true;
+
+	// 0 is kept for "never seen" by the users of the version
+	if (++BoundsVersion == 0)
+	{
+		BoundsVersion = 1;
+	}
+}
+
+void IDrawable::InvalidateStaticGeometry() const
+{
+	if (Static)
+	{
+		gData.SpriteBatcher->InvalidateStaticGeometry();
+	}
+}
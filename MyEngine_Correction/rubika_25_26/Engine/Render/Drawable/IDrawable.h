@@ -1,8 +1,23 @@
 #pragma once
 
+#include <Engine/Math/Affine2D.h>
+
 #include <SFML/Graphics/Drawable.hpp>
-#include <SFML/Graphics/Transform.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Rect.hpp>
+
+#include <cstdint>
+
+// Textured quad in local space, consumed by the SpriteBatcher
+struct DrawableQuad
+{
+	const sf::Texture* Texture;
+	sf::Vector2f Size;
+	sf::IntRect TextureRect;
+	sf::Color Color;
+};
 
 class IDrawable abstract
 {
@@ -16,13 +31,46 @@ public:
 	bool IsVisible() const;
 	void SetVisibility(bool visible);
 
-	const sf::Transform& GetWorldTransform() const;
-	void SetWorldTransform(const sf::Transform& transform);
+	// Drawables are sorted by layer, then by texture: lower layers are drawn first
+	int GetLayer() const;
+	void SetLayer(int layer);
+
+	// Static drawables are baked once by the SpriteBatcher and never follow their entity.
+	// Must be set before the owning entity is added to the game
+	bool IsStatic() const;
+	void SetStatic(bool isStatic);
+
+	const Affine2D& GetWorldTransform() const;
+	void SetWorldTransform(const Affine2D& transform);
+
+	// Box around the quad in world space, only recomputed after the transform or the quad size changed
+	const sf::FloatRect& GetWorldBounds() const;
+	uint32_t GetBoundsVersion() const;
 
 	void Draw(sf::RenderWindow& window) const;
 
+	// Returns false if there is nothing to draw
+	virtual bool GetQuad(DrawableQuad& quad) const = 0;
+
 protected:
 	bool Visible;
-	sf::Transform WorldTransform;
+	bool Static;
+	int Layer;
+	Affine2D WorldTransform;
+	// Member of the derived class, drawn by Draw
 	sf::Drawable* Drawable;
-};
\ No newline at end of file
+
+	// To call when the size of the quad changes
+	void InvalidateBounds();
+
+	// Asks the batcher to rebuild its static geometry if this drawable is static
+	void InvalidateStaticGeometry() const;
+
+	// Called by SetVisibility after Visible changed
+	virtual void OnVisibilityChanged();
+
+private:
+	mutable sf::FloatRect WorldBounds;
+	mutable bool BoundsDirty;
+	uint32_t BoundsVersion;
+};
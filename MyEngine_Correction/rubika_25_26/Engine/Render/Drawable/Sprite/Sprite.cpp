@@ -3,97 +3,206 @@
 #include <Engine/Globals.h>
 #include <Engine/Render/Ressource/TextureMgr.h>
 
-Sprite::Sprite(): IDrawable(), DrawableCasted(nullptr), PlayAnimation(true)
+#include <assert.h>
+#include <cstdlib>
+
+Sprite::Sprite(): IDrawable(), DrawableCasted(TextureMgr::GetEmptyTexture()), PlayAnimation(true)
 {
-	DrawableCasted = new sf::Sprite(TextureMgr::GetEmptyTexture());
-	Drawable = DrawableCasted;
+	Drawable = &DrawableCasted;
 }
 
 Sprite::~Sprite()
 {
-	if (CurrentTexture.size() != 0)
+	UnregisterAnimation();
+
+	if (gData.TextureMgr->IsAlive(CurrentTexture))
 	{
-		const TextureData& textureData = gData.TextureMgr->GetTextureData(CurrentTexture);
-		textureData.Release();
+		gData.TextureMgr->GetTextureData(CurrentTexture).Release();
 	}
-
-	IDrawable::~IDrawable();
 }
 
 void Sprite::Start()
 {}
 
-void Sprite::Update(float deltaTime)
+void Sprite::Update(float)
 {
-	if (PlayAnimation)
+	if (!TextureReady)
 	{
-		CurrentAnimationTime += deltaTime;
-		if (CurrentAnimationTime >= CurrentAnimationData.TimeBetweenAnimationInS)
-		{
-			++CurrentAnimationNb;
-			if (CurrentAnimationNb >= CurrentAnimationData.AnimationSpriteCount)
-			{
-				CurrentAnimationNb = 0;
-			}
-			CurrentAnimationTime = 0;
-		}
+		RefreshTexture();
 	}
+}
 
-	unsigned line = CurrentAnimationNb / CurrentAnimationData.SpriteOnLine;
-	unsigned column = CurrentAnimationNb % CurrentAnimationData.SpriteOnLine;
+void Sprite::Reset()
+{
+	if (AnimationSlot == AnimationSystem::InvalidSlot)
+	{
+		return;
+	}
 
-	sf::IntRect rect;
+	gData.AnimationSystem->Reset(AnimationSlot);
+	ApplyFrame(0);
+}
 
-	if (!CurrentAnimationData.IsReverted)
-	{
-		rect.size.y = CurrentAnimationData.SizeY;
-		rect.position.y = CurrentAnimationData.StartY + line * (CurrentAnimationData.OffsetY + CurrentAnimationData.SizeY);
+void Sprite::SetTexture(const std::string& textureName)
+{
+	SetTexture(gData.TextureMgr->FindTexture(textureName));
+}
 
-		rect.size.x = CurrentAnimationData.SizeX;
-		rect.position.x = CurrentAnimationData.StartX + column * (CurrentAnimationData.OffsetX + CurrentAnimationData.SizeX);
+void Sprite::SetTexture(TextureHandle texture)
+{
+	if (gData.TextureMgr->IsAlive(CurrentTexture))
+	{
+		gData.TextureMgr->GetTextureData(CurrentTexture).Release();
 	}
-	else
+
+	// A name that was never loaded gives an invalid handle: it is kept, and the texture shows as missing
+	if (gData.TextureMgr->IsAlive(texture))
 	{
-		rect.size.y = CurrentAnimationData.SizeY;
-		rect.position.y = CurrentAnimationData.StartY + line * (CurrentAnimationData.OffsetY + CurrentAnimationData.SizeY);
-		
-		rect.size.x = -CurrentAnimationData.SizeX;
-		rect.position.x = CurrentAnimationData.StartX + column * (CurrentAnimationData.OffsetX + CurrentAnimationData.SizeX) + CurrentAnimationData.SizeX;
+		gData.TextureMgr->GetTextureData(texture).AddRef();
 	}
 
-	DrawableCasted->setTextureRect(rect);
+	UnregisterAnimation();
+
+	CurrentTexture = texture;
+	TextureReady = false;
+	AnimationTable = nullptr;
+	CurrentAnimation = AnimationId();
+
+	if (!RefreshTexture())
+	{
+		DrawableCasted.setTexture(TextureMgr::GetMissingTexture(), true);
+		InvalidateBounds();
+	}
 }
 
-void Sprite::Reset()
+void Sprite::SetAnimation(const std::string& animationName)
 {
-	CurrentAnimationTime = 0.f;
-	CurrentAnimationNb = 0;
+	if (!TextureReady)
+	{
+		PendingAnimation = animationName;
+		return;
+	}
+
+	const AnimationId animation = gData.TextureMgr->GetTextureData(CurrentTexture).FindAnimation(animationName);
+	assert(animation.IsValid());
+
+	SetAnimation(animation);
 }
 
-void Sprite::SetTexture(const std::string& textureName)
+void Sprite::SetAnimation(AnimationId animation)
 {
-	if (CurrentTexture.size() != 0)
+	CurrentAnimation = animation;
+	PendingAnimation.clear();
+
+	if (!AnimationTable || !CurrentAnimation.IsValid())
 	{
-		const TextureData& textureData = gData.TextureMgr->GetTextureData(CurrentTexture);
-		textureData.Release();
+		return;
 	}
 
-	const TextureData& textureData = gData.TextureMgr->GetTextureData(textureName);
-	DrawableCasted->setTexture(textureData.Texture);
-	textureData.AddRef();
+	if (AnimationSlot == AnimationSystem::InvalidSlot)
+	{
+		AnimationSlot = gData.AnimationSystem->Register(*this);
+	}
 
-	CurrentTexture = textureName;
+	gData.AnimationSystem->SetAnimation(AnimationSlot, AnimationTable[CurrentAnimation.Index]);
+	gData.AnimationSystem->SetPlaying(AnimationSlot, PlayAnimation && Visible);
+	ApplyFrame(gData.AnimationSystem->GetFrame(AnimationSlot));
 }
 
-void Sprite::SetAnimation(const std::string& animationName)
+bool Sprite::RefreshTexture()
 {
+	if (!gData.TextureMgr->IsAlive(CurrentTexture))
+	{
+		return false;
+	}
+
 	const TextureData& textureData = gData.TextureMgr->GetTextureData(CurrentTexture);
-	CurrentAnimationData  = textureData.AnimationsData.at(animationName);
+	if (!textureData.IsReady())
+	{
+		return false;
+	}
 
-	CurrentAnimation = animationName;
+	DrawableCasted.setTexture(*textureData.Texture);
+	InvalidateBounds();
+	AnimationTable = textureData.Animations.data();
+	TextureReady = true;
+
+	if (PendingAnimation.size() != 0)
+	{
+		SetAnimation(PendingAnimation);
+	}
+
+	return true;
+}
+
+void Sprite::ApplyFrame(int frame)
+{
+	const AnimationData& animationData = AnimationTable[CurrentAnimation.Index];
+
+	unsigned line = frame / animationData.SpriteOnLine;
+	unsigned column = frame % animationData.SpriteOnLine;
+
+	sf::IntRect rect;
+
+	if (!animationData.IsReverted)
+	{
+		rect.size.y = animationData.SizeY;
+		rect.position.y = animationData.StartY + line * (animationData.OffsetY + animationData.SizeY);
+
+		rect.size.x = animationData.SizeX;
+		rect.position.x = animationData.StartX + column * (animationData.OffsetX + animationData.SizeX);
+	}
+	else
+	{
+		rect.size.y = animationData.SizeY;
+		rect.position.y = animationData.StartY + line * (animationData.OffsetY + animationData.SizeY);
+		
+		rect.size.x = -animationData.SizeX;
+		rect.position.x = animationData.StartX + column * (animationData.OffsetX + animationData.SizeX) + animationData.SizeX;
+	}
+
+	DrawableCasted.setTextureRect(rect);
+	InvalidateBounds();
+}
+
+void Sprite::UnregisterAnimation()
+{
+	if (AnimationSlot == AnimationSystem::InvalidSlot)
+	{
+		return;
+	}
+
+	gData.AnimationSystem->Unregister(AnimationSlot);
+	AnimationSlot = AnimationSystem::InvalidSlot;
 }
 
 void Sprite::EnableAnimation(bool enable)
 {
 	PlayAnimation = enable;
+
+	if (AnimationSlot != AnimationSystem::InvalidSlot)
+	{
+		gData.AnimationSystem->SetPlaying(AnimationSlot, PlayAnimation && Visible);
+	}
+}
+
+void Sprite::OnVisibilityChanged()
+{
+	// Hidden sprites keep their frame until they are shown again
+	if (AnimationSlot != AnimationSystem::InvalidSlot)
+	{
+		gData.AnimationSystem->SetPlaying(AnimationSlot, PlayAnimation && Visible);
+	}
+}
+
+bool Sprite::GetQuad(DrawableQuad& quad) const
+{
+	const sf::IntRect& rect = DrawableCasted.getTextureRect();
+
+	quad.Texture = &DrawableCasted.getTexture();
+	quad.Size = sf::Vector2f((float)std::abs(rect.size.x), (float)std::abs(rect.size.y));
+	quad.TextureRect = rect;
+	quad.Color = DrawableCasted.getColor();
+
+	return rect.size.x != 0 && rect.size.y != 0;
 }
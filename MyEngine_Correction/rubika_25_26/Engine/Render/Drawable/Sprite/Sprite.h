@@ -1,13 +1,15 @@
 #pragma once
 
 #include <Engine/Render/Drawable/IDrawable.h>
+#include <Engine/Render/Animation/AnimationSystem.h>
 #include <Engine/Render/Ressource/TextureMgr.h>
+#include <Engine/Memory/ObjectPool.h>
 
 #include <SFML/Graphics/Sprite.hpp>
 #include <string>
 
 
-class Sprite : public IDrawable
+class Sprite : public IDrawable, public PooledObject<Sprite>
 {
 public:
 	Sprite();
@@ -18,20 +20,37 @@ public:
 	void Reset();
 
 	void SetTexture(const std::string& textureName);
+	void SetTexture(TextureHandle texture);
 	void SetAnimation(const std::string& animationName);
+	void SetAnimation(AnimationId animation);
 
 	void EnableAnimation(bool play);
 
+	virtual bool GetQuad(DrawableQuad& quad) const override;
+
 protected:
+	friend class AnimationSystem;
+
+	sf::Sprite DrawableCasted;
 
-	sf::Sprite* DrawableCasted;
-	AnimationData CurrentAnimationData;
+	TextureHandle CurrentTexture;
 
-	std::string CurrentTexture;
-	std::string CurrentAnimation;
+	// Points in the animation table of the texture, which is kept alive by our reference
+	const AnimationData* AnimationTable = nullptr;
+	AnimationId CurrentAnimation;
 
-	int CurrentAnimationNb = 0;
-	float CurrentAnimationTime = 0.f;
+	// Frame and time are stepped by the AnimationSystem, which owns them while the sprite is registered
+	uint32_t AnimationSlot = AnimationSystem::InvalidSlot;
 
 	bool PlayAnimation;
+
+	// The texture may still be loading: show the missing texture and keep the animation until it is ready
+	bool TextureReady = false;
+	std::string PendingAnimation;
+
+	virtual void OnVisibilityChanged() override;
+
+	bool RefreshTexture();
+	void ApplyFrame(int frame);
+	void UnregisterAnimation();
 };
\ No newline at end of file
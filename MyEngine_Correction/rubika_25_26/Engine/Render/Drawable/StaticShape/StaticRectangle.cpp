@@ -3,27 +3,122 @@
 #include <Engine/Globals.h>
 #include <Engine/Render/Ressource/TextureMgr.h>
 
-StaticRectangle::StaticRectangle(): DrawableCasted(nullptr), CurrentTexture(""), CurrentTile(""), TileData()
+StaticRectangle::StaticRectangle(): DrawableCasted(), CurrentTexture(), CurrentTile(""), TileData()
 {
-	DrawableCasted = new sf::RectangleShape();
-	Drawable = DrawableCasted;
+	Drawable = &DrawableCasted;
+
+	// Room tiles never move, bake them by default
+	Static = true;
 }
 
 StaticRectangle::~StaticRectangle()
 {
-	if (CurrentTexture.size() != 0)
+	if (gData.TextureMgr->IsAlive(CurrentTexture))
 	{
-		const TextureData& textureData = gData.TextureMgr->GetTextureData(CurrentTexture);
-		textureData.Release();
+		gData.TextureMgr->GetTextureData(CurrentTexture).Release();
 	}
+}
+
+void StaticRectangle::Start()
+{
+	ApplyTile();
+}
 
-	if (DrawableCasted)
+void StaticRectangle::Update(float)
+{
+	if (!TextureReady)
 	{
-		DrawableCasted = nullptr;
+		RefreshTexture();
 	}
 }
 
-void StaticRectangle::Start()
+void StaticRectangle::SetTexture(const std::string& textureName)
+{
+	SetTexture(gData.TextureMgr->FindTexture(textureName));
+}
+
+void StaticRectangle::SetTexture(TextureHandle texture)
+{
+	if (gData.TextureMgr->IsAlive(CurrentTexture))
+	{
+		gData.TextureMgr->GetTextureData(CurrentTexture).Release();
+	}
+
+	// A name that was never loaded gives an invalid handle: it is kept, and the texture shows as missing
+	if (gData.TextureMgr->IsAlive(texture))
+	{
+		gData.TextureMgr->GetTextureData(texture).AddRef();
+	}
+
+	CurrentTexture = texture;
+	TextureReady = false;
+
+	if (!RefreshTexture())
+	{
+		DrawableCasted.setTexture(nullptr);
+		InvalidateStaticGeometry();
+	}
+}
+
+void StaticRectangle::SetTile(const std::string& tileNameName)
+{
+	if (!TextureReady)
+	{
+		PendingTile = tileNameName;
+		return;
+	}
+
+	const TextureData& textureData = gData.TextureMgr->GetTextureData(CurrentTexture);
+	TileData = textureData.StaticTilesData.at(tileNameName);
+
+	CurrentTile = tileNameName;
+	PendingTile.clear();
+	ApplyTile();
+}
+
+void StaticRectangle::SetFillColor(sf::Color color)
+{
+	DrawableCasted.setFillColor(color);
+	InvalidateStaticGeometry();
+}
+
+bool StaticRectangle::GetQuad(DrawableQuad& quad) const
+{
+	quad.Texture = DrawableCasted.getTexture();
+	quad.Size = DrawableCasted.getSize();
+	quad.TextureRect = DrawableCasted.getTextureRect();
+	quad.Color = DrawableCasted.getFillColor();
+
+	// Nothing is baked until the texture and the tile are known
+	return quad.Texture && quad.Size.x != 0.f && quad.Size.y != 0.f;
+}
+
+bool StaticRectangle::RefreshTexture()
+{
+	if (!gData.TextureMgr->IsAlive(CurrentTexture))
+	{
+		return false;
+	}
+
+	const TextureData& textureData = gData.TextureMgr->GetTextureData(CurrentTexture);
+	if (!textureData.IsReady())
+	{
+		return false;
+	}
+
+	DrawableCasted.setTexture(textureData.Texture);
+	TextureReady = true;
+
+	if (PendingTile.size() != 0)
+	{
+		SetTile(PendingTile);
+	}
+
+	InvalidateStaticGeometry();
+	return true;
+}
+
+void StaticRectangle::ApplyTile()
 {
 	sf::IntRect rect;
 	if (!TileData.IsRevertedX)
@@ -48,37 +143,9 @@ void StaticRectangle::Start()
 		rect.position.y = TileData.StartY + TileData.SizeY;
 	}
 
-	DrawableCasted->setSize(sf::Vector2f((float)TileData.SizeX, (float) TileData.SizeY));
-	DrawableCasted->setTextureRect(rect);
-}
+	DrawableCasted.setSize(sf::Vector2f((float)TileData.SizeX, (float) TileData.SizeY));
+	DrawableCasted.setTextureRect(rect);
 
-void StaticRectangle::Update(float)
-{}
-
-void StaticRectangle::SetTexture(const std::string& textureName)
-{
-	if (CurrentTexture.size() != 0)
-	{
-		const TextureData& textureData = gData.TextureMgr->GetTextureData(textureName);
-		textureData.Release();
-	}
-
-	const TextureData& textureData = gData.TextureMgr->GetTextureData(textureName);
-	DrawableCasted->setTexture(&textureData.Texture);
-	textureData.AddRef();
-
-	CurrentTexture = textureName;
-}
-
-void StaticRectangle::SetTile(const std::string& tileNameName)
-{
-	const TextureData& textureData = gData.TextureMgr->GetTextureData(CurrentTexture);
-	TileData = textureData.StaticTilesData.at(tileNameName);
-
-	CurrentTile = tileNameName;
-}
-
-void StaticRectangle::SetFillColor(sf::Color color)
-{
-	DrawableCasted->setFillColor(color);
+	InvalidateBounds();
+	InvalidateStaticGeometry();
 }
@@ -2,11 +2,12 @@
 
 #include <Engine/Render/Drawable/IDrawable.h>
 #include <Engine/Render/Ressource/TextureMgr.h>
+#include <Engine/Memory/ObjectPool.h>
 #include <SFML/Graphics/RectangleShape.hpp>
 
 #include <string>
 
-class StaticRectangle : public IDrawable
+class StaticRectangle : public IDrawable, public PooledObject<StaticRectangle>
 {
 public:
 	StaticRectangle();
@@ -16,13 +17,23 @@ public:
 	virtual void Update(float deltaTime) override;
 
 	void SetTexture(const std::string& textureName);
+	void SetTexture(TextureHandle texture);
 	void SetTile(const std::string& animationName);
 	void SetFillColor(sf::Color color);
 
+	virtual bool GetQuad(DrawableQuad& quad) const override;
+
 protected:
-	sf::RectangleShape* DrawableCasted;
-	std::string CurrentTexture;
+	sf::RectangleShape DrawableCasted;
+	TextureHandle CurrentTexture;
 	std::string CurrentTile;
 
 	StaticTileData TileData;
+
+	// The texture may still be loading: draw nothing and keep the tile until it is ready
+	bool TextureReady = false;
+	std::string PendingTile;
+
+	bool RefreshTexture();
+	void ApplyTile();
 };
\ No newline at end of file
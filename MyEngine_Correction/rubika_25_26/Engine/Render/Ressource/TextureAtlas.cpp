@@ -0,0 +1,204 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+TextureAtlas::TextureAtlas(unsigned int pageSize, unsigned int padding) : PageSize(pageSize), Padding(padding)
+{}
+
+TextureAtlas::~TextureAtlas()
+{
+	for (Page* page : Pages)
+	{
+		delete page;
+	}
+
+	Pages.clear();
+}
+
+bool TextureAtlas::Insert(const sf::Image& image, Region& region)
+{
+	const sf::Vector2u imageSize = image.getSize();
+	if (imageSize.x == 0 || imageSize.y == 0)
+	{
+		return false;
+	}
+
+	// Keep a gap between images so that flipped or filtered rects never sample a neighbour
+	const unsigned int width = imageSize.x + Padding;
+	const unsigned int height = imageSize.y + Padding;
+	const unsigned int pageSize = std::min(PageSize, sf::Texture::getMaximumSize());
+
+	Page* target = nullptr;
+	size_t node = 0;
+	sf::Vector2u position;
+
+	if (width > pageSize || height > pageSize)
+	{
+		target = CreatePage(imageSize);
+		if (!target)
+		{
+			return false;
+		}
+
+		target->Skyline.clear();
+		position = sf::Vector2u(0, 0);
+	}
+	else
+	{
+		for (Page* page : Pages)
+		{
+			if (!page->Skyline.empty() && FindPosition(*page, width, height, node, position))
+			{
+				target = page;
+				break;
+			}
+		}
+
+		if (!target)
+		{
+			target = CreatePage(sf::Vector2u(pageSize, pageSize));
+			if (!target || !FindPosition(*target, width, height, node, position))
+			{
+				return false;
+			}
+		}
+
+		AddSkylineLevel(*target, node, position, width, height);
+	}
+
+	target->Texture.update(image, position);
+	target->UsedArea += (unsigned long long)imageSize.x * imageSize.y;
+
+	region.Page = &target->Texture;
+	region.Position = position;
+	region.Size = imageSize;
+	return true;
+}
+
+size_t TextureAtlas::GetPageCount() const
+{
+	return Pages.size();
+}
+
+const sf::Texture& TextureAtlas::GetPage(size_t index) const
+{
+	return Pages[index]->Texture;
+}
+
+float TextureAtlas::GetPageOccupancy(size_t index) const
+{
+	const sf::Vector2u size = Pages[index]->Texture.getSize();
+	return (float)Pages[index]->UsedArea / (float)((unsigned long long)size.x * size.y);
+}
+
+TextureAtlas::Page* TextureAtlas::CreatePage(sf::Vector2u size)
+{
+	Page* page = new Page();
+	if (!page->Texture.resize(size))
+	{
+		std::cerr << "TextureAtlas: Cannot create a page of " << size.x << "x" << size.y << std::endl;
+		delete page;
+		return nullptr;
+	}
+
+	page->Skyline.push_back(SkylineNode{ 0, 0, size.x });
+	Pages.push_back(page);
+	return page;
+}
+
+bool TextureAtlas::FindPosition(const Page& page, unsigned int width, unsigned int height, size_t& bestNode, sf::Vector2u& position) const
+{
+	unsigned int bestY = std::numeric_limits<unsigned int>::max();
+	unsigned int bestWidth = std::numeric_limits<unsigned int>::max();
+	bool found = false;
+
+	for (size_t i = 0; i < page.Skyline.size(); ++i)
+	{
+		unsigned int y = 0;
+		if (!FitsAt(page, i, width, height, y))
+		{
+			continue;
+		}
+
+		// Bottom-left heuristic: lowest position first, then the narrowest segment
+		if (y < bestY || (y == bestY && page.Skyline[i].Width < bestWidth))
+		{
+			bestY = y;
+			bestWidth = page.Skyline[i].Width;
+			bestNode = i;
+			position = sf::Vector2u(page.Skyline[i].X, y);
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+bool TextureAtlas::FitsAt(const Page& page, size_t node, unsigned int width, unsigned int height, unsigned int& y) const
+{
+	const sf::Vector2u pageSize = page.Texture.getSize();
+	if (page.Skyline[node].X + width > pageSize.x)
+	{
+		return false;
+	}
+
+	// The image lies on the highest segment it spans
+	y = 0;
+	unsigned int remainingWidth = width;
+	for (size_t i = node; remainingWidth > 0; ++i)
+	{
+		if (i == page.Skyline.size())
+		{
+			return false;
+		}
+
+		y = std::max(y, page.Skyline[i].Y);
+		if (y + height > pageSize.y)
+		{
+			return false;
+		}
+
+		remainingWidth -= std::min(remainingWidth, page.Skyline[i].Width);
+	}
+
+	return true;
+}
+
+void TextureAtlas::AddSkylineLevel(Page& page, size_t node, const sf::Vector2u& position, unsigned int width, unsigned int height)
+{
+	std::vector<SkylineNode>& skyline = page.Skyline;
+	skyline.insert(skyline.begin() + node, SkylineNode{ position.x, position.y + height, width });
+
+	// Shrink or remove the segments now covered by the new one
+	const unsigned int right = position.x + width;
+	size_t i = node + 1;
+	while (i < skyline.size() && skyline[i].X < right)
+	{
+		const unsigned int segmentRight = skyline[i].X + skyline[i].Width;
+		if (segmentRight <= right)
+		{
+			skyline.erase(skyline.begin() + i);
+			continue;
+		}
+
+		skyline[i].Width = segmentRight - right;
+		skyline[i].X = right;
+		break;
+	}
+
+	// Merge neighbours at the same height
+	for (size_t j = 0; j + 1 < skyline.size();)
+	{
+		if (skyline[j].Y == skyline[j + 1].Y)
+		{
+			skyline[j].Width += skyline[j + 1].Width;
+			skyline.erase(skyline.begin() + j + 1);
+		}
+		else
+		{
+			++j;
+		}
+	}
+}
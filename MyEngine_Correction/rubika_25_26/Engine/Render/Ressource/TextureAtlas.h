@@ -0,0 +1,57 @@
+#pragma once
+
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Image.hpp>
+
+#include <vector>
+
+// Packs images in a few large textures (pages) so that most drawables share the same texture.
+// Images are placed with a skyline bottom-left packer and never move once inserted.
+class TextureAtlas
+{
+public:
+	TextureAtlas(unsigned int pageSize = 2048, unsigned int padding = 2);
+	~TextureAtlas();
+
+	TextureAtlas(const TextureAtlas&) = delete;
+	TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+	struct Region
+	{
+		const sf::Texture* Page;
+		sf::Vector2u Position;
+		sf::Vector2u Size;
+	};
+
+	// Copies the image in a page. Images bigger than a page get a page of their own
+	bool Insert(const sf::Image& image, Region& region);
+
+	size_t GetPageCount() const;
+	const sf::Texture& GetPage(size_t index) const;
+	float GetPageOccupancy(size_t index) const;
+
+private:
+
+	struct SkylineNode
+	{
+		unsigned int X;
+		unsigned int Y;
+		unsigned int Width;
+	};
+
+	struct Page
+	{
+		sf::Texture Texture;
+		std::vector<SkylineNode> Skyline;
+		unsigned long long UsedArea = 0;
+	};
+
+	std::vector<Page*> Pages;
+	unsigned int PageSize;
+	unsigned int Padding;
+
+	Page* CreatePage(sf::Vector2u size);
+	bool FindPosition(const Page& page, unsigned int width, unsigned int height, size_t& bestNode, sf::Vector2u& position) const;
+	bool FitsAt(const Page& page, size_t node, unsigned int width, unsigned int height, unsigned int& y) const;
+	void AddSkylineLevel(Page& page, size_t node, const sf::Vector2u& position, unsigned int width, unsigned int height);
+};
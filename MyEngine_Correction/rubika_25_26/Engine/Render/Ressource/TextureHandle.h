@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+// Reference on a texture of TextureMgr, resolved without any string lookup.
+// The generation changes when a slot is reused, so a handle on an unloaded texture is detected as stale.
+struct TextureHandle
+{
+	static constexpr uint32_t InvalidIndex = 0xFFFFFFFF;
+
+	uint32_t Index = InvalidIndex;
+	uint32_t Generation = 0;
+
+	bool IsValid() const { return Index != InvalidIndex; }
+	bool operator==(const TextureHandle& other) const = default;
+};
@@ -0,0 +1,344 @@
+#include "TextureMetadata.h"
+
+#include <rapidxml/rapidxml_utils.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+	// Parses the node value in place, without building a temporary string. Keeps the current value if the node is missing or invalid
+	template <typename T>
+	void ReadValue(rapidxml::xml_node<>* parent, const char* name, T& value)
+	{
+		rapidxml::xml_node<>* node = parent->first_node(name);
+		if (!node)
+		{
+			return;
+		}
+
+		const char* first = node->value();
+		const char* last = first + node->value_size();
+		while (first != last && (*first == ' ' || *first == '\t' || *first == '\r' || *first == '\n'))
+		{
+			++first;
+		}
+
+		T parsed;
+		if (std::from_chars(first, last, parsed).ec == std::errc())
+		{
+			value = parsed;
+		}
+	}
+
+	void ReadValue(rapidxml::xml_node<>* parent, const char* name, bool& value)
+	{
+		int parsed = value ? 1 : 0;
+		ReadValue(parent, name, parsed);
+		value = parsed != 0;
+	}
+}
+
+bool TextureMetadata::LoadFromXml(const std::filesystem::path& path, AnimationDataMap& animations, StaticTileDataMap& staticTiles)
+{
+	rapidxml::file<> metadataFile(path.string().c_str());
+	if (metadataFile.size() == 0)
+	{
+		std::cerr << "LoadTextureMetadata: Cannot open file " << path << std::endl;
+		return false;
+	}
+
+	rapidxml::xml_document metadataXml;
+	metadataXml.parse<0>(metadataFile.data());
+
+	if (rapidxml::xml_node<>* node = metadataXml.first_node("Animations"))
+	{
+		if (!LoadAnimations(node, animations))
+		{
+			return false;
+		}
+	}
+
+	if (rapidxml::xml_node<>* node = metadataXml.first_node("Backgrounds"))
+	{
+		if (!LoadStaticTiles(node, staticTiles))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool TextureMetadata::LoadAnimations(rapidxml::xml_node<>* node, AnimationDataMap& animations)
+{
+	if (!node)
+	{
+		return false;
+	}
+
+	rapidxml::xml_node<>* animationNode = node->first_node();
+	while (animationNode)
+	{
+		rapidxml::xml_attribute<>* nameAttribute = animationNode->first_attribute("Name");
+		if (nameAttribute)
+		{
+			auto p = animations.emplace(std::string(nameAttribute->value(), nameAttribute->value_size()), AnimationData());
+			if (p.second)
+			{
+				AnimationData& data = p.first->second;
+				ReadValue(animationNode, "X", data.StartX);
+				ReadValue(animationNode, "Y", data.StartY);
+				ReadValue(animationNode, "SizeX", data.SizeX);
+				ReadValue(animationNode, "SizeY", data.SizeY);
+				ReadValue(animationNode, "OffsetX", data.OffsetX);
+				ReadValue(animationNode, "OffsetY", data.OffsetY);
+				ReadValue(animationNode, "SpriteNum", data.AnimationSpriteCount);
+				ReadValue(animationNode, "SpritesOnLine", data.SpriteOnLine);
+				ReadValue(animationNode, "Reverted", data.IsReverted);
+				ReadValue(animationNode, "TimeBetweenAnimation", data.TimeBetweenAnimationInS);
+			}
+			else
+			{
+				std::cerr << "LoadAnimationMetadata: Cannot add animation " << nameAttribute->value() << ". Ignore it" << std::endl;
+			}
+		}
+		else
+		{
+			std::cerr << "LoadAnimationMetadata: Find a animation node with no name. Ignore it" << std::endl;
+		}
+
+		animationNode = animationNode->next_sibling();
+	}
+
+	return true;
+}
+
+bool TextureMetadata::LoadStaticTiles(rapidxml::xml_node<>* node, StaticTileDataMap& staticTiles)
+{
+	if (!node)
+	{
+		return false;
+	}
+
+	rapidxml::xml_node<>* tileNode = node->first_node();
+	while (tileNode)
+	{
+		rapidxml::xml_attribute<>* nameAttribute = tileNode->first_attribute("Name");
+		if (nameAttribute)
+		{
+			auto p = staticTiles.emplace(std::string(nameAttribute->value(), nameAttribute->value_size()), StaticTileData());
+			if (p.second)
+			{
+				StaticTileData& data = p.first->second;
+				ReadValue(tileNode, "X", data.StartX);
+				ReadValue(tileNode, "Y", data.StartY);
+				ReadValue(tileNode, "SizeX", data.SizeX);
+				ReadValue(tileNode, "SizeY", data.SizeY);
+				ReadValue(tileNode, "RevertedX", data.IsRevertedX);
+				ReadValue(tileNode, "RevertedY", data.IsRevertedY);
+			}
+			else
+			{
+				std::cerr << "LoadStaticTileMetadata: Cannot add static Data " << nameAttribute->value() << ". Ignore it" << std::endl;
+			}
+		}
+		else
+		{
+			std::cerr << "LoadStaticTileMetadata: Find a tile node with no name. Ignore it" << std::endl;
+		}
+
+		tileNode = tileNode->next_sibling();
+	}
+
+	return true;
+}
+
+bool TextureMetadata::LoadCooked(const std::filesystem::path& path, AnimationDataMap& animations, StaticTileDataMap& staticTiles)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		std::cerr << "LoadCookedMetadata: Cannot open file " << path << std::endl;
+		return false;
+	}
+
+	std::vector<char> buffer((size_t)file.tellg());
+	file.seekg(0);
+	if (!file.read(buffer.data(), buffer.size()))
+	{
+		std::cerr << "LoadCookedMetadata: Cannot read file " << path << std::endl;
+		return false;
+	}
+
+	return LoadCooked(reinterpret_cast<const unsigned char*>(buffer.data()), buffer.size(), animations, staticTiles);
+}
+
+// Records are copied field by field out of the buffer, which can be a view on a mapped pack
+bool TextureMetadata::LoadCooked(const unsigned char* data, size_t size, AnimationDataMap& animations, StaticTileDataMap& staticTiles)
+{
+	CookedHeader header;
+	if (size < sizeof(header))
+	{
+		std::cerr << "LoadCookedMetadata: Truncated data" << std::endl;
+		return false;
+	}
+
+	memcpy(&header, data, sizeof(header));
+	if (header.Magic != CookedMagic || header.Version != CookedVersion)
+	{
+		std::cerr << "LoadCookedMetadata: Unsupported version. Cook it again" << std::endl;
+		return false;
+	}
+
+	const size_t animationsOffset = sizeof(CookedHeader);
+	const size_t staticTilesOffset = animationsOffset + header.AnimationCount * sizeof(CookedAnimation);
+	const size_t stringTableOffset = staticTilesOffset + header.StaticTileCount * sizeof(CookedStaticTile);
+	if (size != stringTableOffset + header.StringTableSize)
+	{
+		std::cerr << "LoadCookedMetadata: Corrupted data" << std::endl;
+		return false;
+	}
+
+	const char* stringTable = reinterpret_cast<const char*>(data) + stringTableOffset;
+
+	animations.reserve(animations.size() + header.AnimationCount);
+	for (uint32_t i = 0; i < header.AnimationCount; ++i)
+	{
+		CookedAnimation record;
+		memcpy(&record, data + animationsOffset + i * sizeof(CookedAnimation), sizeof(record));
+		if ((size_t)record.NameOffset + record.NameSize > header.StringTableSize)
+		{
+			std::cerr << "LoadCookedMetadata: Corrupted animation name" << std::endl;
+			return false;
+		}
+
+		AnimationData& data = animations[std::string(stringTable + record.NameOffset, record.NameSize)];
+		data.StartX = record.StartX;
+		data.StartY = record.StartY;
+		data.SizeX = record.SizeX;
+		data.SizeY = record.SizeY;
+		data.OffsetX = record.OffsetX;
+		data.OffsetY = record.OffsetY;
+		data.AnimationSpriteCount = record.AnimationSpriteCount;
+		data.SpriteOnLine = record.SpriteOnLine;
+		data.IsReverted = record.IsReverted != 0;
+		data.TimeBetweenAnimationInS = record.TimeBetweenAnimationInS;
+	}
+
+	staticTiles.reserve(staticTiles.size() + header.StaticTileCount);
+	for (uint32_t i = 0; i < header.StaticTileCount; ++i)
+	{
+		CookedStaticTile record;
+		memcpy(&record, data + staticTilesOffset + i * sizeof(CookedStaticTile), sizeof(record));
+		if ((size_t)record.NameOffset + record.NameSize > header.StringTableSize)
+		{
+			std::cerr << "LoadCookedMetadata: Corrupted tile name" << std::endl;
+			return false;
+		}
+
+		StaticTileData& data = staticTiles[std::string(stringTable + record.NameOffset, record.NameSize)];
+		data.StartX = record.StartX;
+		data.StartY = record.StartY;
+		data.SizeX = record.SizeX;
+		data.SizeY = record.SizeY;
+		data.IsRevertedX = record.IsRevertedX != 0;
+		data.IsRevertedY = record.IsRevertedY != 0;
+	}
+
+	return true;
+}
+
+bool TextureMetadata::SaveCooked(const std::filesystem::path& path, const AnimationDataMap& animations, const StaticTileDataMap& staticTiles)
+{
+	std::vector<unsigned char> cooked;
+	Cook(animations, staticTiles, cooked);
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cerr << "SaveCookedMetadata: Cannot open file " << path << std::endl;
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(cooked.data()), cooked.size());
+	return (bool)file;
+}
+
+void TextureMetadata::Cook(const AnimationDataMap& animations, const StaticTileDataMap& staticTiles, std::vector<unsigned char>& cooked)
+{
+	std::string stringTable;
+	auto addString = [&stringTable](const std::string& name, uint32_t& offset, uint32_t& size)
+	{
+		offset = (uint32_t)stringTable.size();
+		size = (uint32_t)name.size();
+		stringTable += name;
+	};
+
+	std::vector<CookedAnimation> animationRecords;
+	animationRecords.reserve(animations.size());
+	for (const auto& [name, data] : animations)
+	{
+		CookedAnimation record = {};
+		addString(name, record.NameOffset, record.NameSize);
+		record.StartX = data.StartX;
+		record.StartY = data.StartY;
+		record.SizeX = data.SizeX;
+		record.SizeY = data.SizeY;
+		record.OffsetX = data.OffsetX;
+		record.OffsetY = data.OffsetY;
+		record.AnimationSpriteCount = data.AnimationSpriteCount;
+		record.SpriteOnLine = data.SpriteOnLine;
+		record.TimeBetweenAnimationInS = data.TimeBetweenAnimationInS;
+		record.IsReverted = data.IsReverted ? 1 : 0;
+		animationRecords.push_back(record);
+	}
+
+	std::vector<CookedStaticTile> staticTileRecords;
+	staticTileRecords.reserve(staticTiles.size());
+	for (const auto& [name, data] : staticTiles)
+	{
+		CookedStaticTile record = {};
+		addString(name, record.NameOffset, record.NameSize);
+		record.StartX = data.StartX;
+		record.StartY = data.StartY;
+		record.SizeX = data.SizeX;
+		record.SizeY = data.SizeY;
+		record.IsRevertedX = data.IsRevertedX ? 1 : 0;
+		record.IsRevertedY = data.IsRevertedY ? 1 : 0;
+		staticTileRecords.push_back(record);
+	}
+
+	CookedHeader header;
+	header.Magic = CookedMagic;
+	header.Version = CookedVersion;
+	header.AnimationCount = (uint32_t)animationRecords.size();
+	header.StaticTileCount = (uint32_t)staticTileRecords.size();
+	header.StringTableSize = (uint32_t)stringTable.size();
+
+	const size_t animationsSize = animationRecords.size() * sizeof(CookedAnimation);
+	const size_t staticTilesSize = staticTileRecords.size() * sizeof(CookedStaticTile);
+
+	cooked.resize(sizeof(header) + animationsSize + staticTilesSize + stringTable.size());
+	unsigned char* output = cooked.data();
+
+	const unsigned char* headerBytes = reinterpret_cast<const unsigned char*>(&header);
+	const unsigned char* animationBytes = reinterpret_cast<const unsigned char*>(animationRecords.data());
+	const unsigned char* staticTileBytes = reinterpret_cast<const unsigned char*>(staticTileRecords.data());
+
+	output = std::copy(headerBytes, headerBytes + sizeof(header), output);
+	output = std::copy(animationBytes, animationBytes + animationsSize, output);
+	output = std::copy(staticTileBytes, staticTileBytes + staticTilesSize, output);
+	std::copy(stringTable.begin(), stringTable.end(), output);
+}
+
+AnimationData::AnimationData(): StartX(0), StartY(0), SizeX(0), SizeY(0),
+OffsetX(0), OffsetY(0), AnimationSpriteCount(0), SpriteOnLine(0), IsReverted(false), TimeBetweenAnimationInS(0.f)
+{}
+
+StaticTileData::StaticTileData(): StartX(0), StartY(0), SizeX(0), SizeY(0), IsRevertedX(false), IsRevertedY(false)
+{}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <rapidxml/rapidxml.hpp>
+
+#include <unordered_map>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct AnimationData
+{
+	AnimationData();
+
+	int StartX;
+	int StartY;
+	int SizeX;
+	int SizeY;
+	int OffsetX;
+	int OffsetY;
+	int AnimationSpriteCount;
+	int SpriteOnLine;
+	bool IsReverted;
+	float TimeBetweenAnimationInS;
+};
+
+struct StaticTileData
+{
+	StaticTileData();
+
+	int StartX;
+	int StartY;
+	int SizeX;
+	int SizeY;
+	bool IsRevertedX;
+	bool IsRevertedY;
+};
+
+using AnimationDataMap = std::unordered_map<std::string, AnimationData>;
+using StaticTileDataMap = std::unordered_map<std::string, StaticTileData>;
+
+// Reads and writes the animations and tiles described next to a texture.
+// The .xml sidecar is the source format, the cook step converts it to a binary .tmd file loaded without any parsing.
+// Shared by the engine and the AssetCooker tool: must not depend on anything else in the engine.
+class TextureMetadata
+{
+public:
+	static constexpr const char* CookedExtension = ".tmd";
+
+	static bool LoadFromXml(const std::filesystem::path& path, AnimationDataMap& animations, StaticTileDataMap& staticTiles);
+
+	static bool LoadCooked(const std::filesystem::path& path, AnimationDataMap& animations, StaticTileDataMap& staticTiles);
+	static bool LoadCooked(const unsigned char* data, size_t size, AnimationDataMap& animations, StaticTileDataMap& staticTiles);
+	static bool SaveCooked(const std::filesystem::path& path, const AnimationDataMap& animations, const StaticTileDataMap& staticTiles);
+	static void Cook(const AnimationDataMap& animations, const StaticTileDataMap& staticTiles, std::vector<unsigned char>& cooked);
+
+private:
+	static bool LoadAnimations(rapidxml::xml_node<>* node, AnimationDataMap& animations);
+	static bool LoadStaticTiles(rapidxml::xml_node<>* node, StaticTileDataMap& staticTiles);
+
+	// Cooked layout, little endian: header, animation records, tile records, then the names packed in a string table
+	static constexpr uint32_t CookedMagic = 0x444D5452; // "RTMD"
+	static constexpr uint32_t CookedVersion = 1;
+
+	struct CookedHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t AnimationCount;
+		uint32_t StaticTileCount;
+		uint32_t StringTableSize;
+	};
+
+	struct CookedAnimation
+	{
+		uint32_t NameOffset;
+		uint32_t NameSize;
+		int32_t StartX;
+		int32_t StartY;
+		int32_t SizeX;
+		int32_t SizeY;
+		int32_t OffsetX;
+		int32_t OffsetY;
+		int32_t AnimationSpriteCount;
+		int32_t SpriteOnLine;
+		float TimeBetweenAnimationInS;
+		uint8_t IsReverted;
+		uint8_t Padding[3];
+	};
+
+	struct CookedStaticTile
+	{
+		uint32_t NameOffset;
+		uint32_t NameSize;
+		int32_t StartX;
+		int32_t StartY;
+		int32_t SizeX;
+		int32_t SizeY;
+		uint8_t IsRevertedX;
+		uint8_t IsRevertedY;
+		uint8_t Padding[2];
+	};
+
+	static_assert(sizeof(CookedHeader) == 20, "Cooked header layout changed, bump CookedVersion");
+	static_assert(sizeof(CookedAnimation) == 48, "Cooked animation layout changed, bump CookedVersion");
+	static_assert(sizeof(CookedStaticTile) == 28, "Cooked tile layout changed, bump CookedVersion");
+};
@@ -1,297 +1,532 @@
 #include "TextureMgr.h"
 
 #include <Engine/Globals.h>
-#include <rapidxml/rapidxml_utils.hpp>
+#include <Engine/Ressource/AssetPack.h>
+#include <Engine/Profiler.h>
+#include <Engine/Memory/MemoryTracker.h>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Time.hpp>
 
 #ifdef _USE_IMGUI
 #include <Imgui/imgui.h>
 #include <Imgui/imgui-SFML.h>
 #endif
 
+#include <algorithm>
 #include <assert.h>
 #include <filesystem>
 #include <iostream>
 
-TextureMgr::TextureMgr()
+TextureMgr::TextureMgr() : PendingLoadCount(0), StopWorkers(false)
 {}
 
 TextureMgr::~TextureMgr()
 {
-	for (const auto& p : Textures)
+	StopAndJoinWorkers();
+
+	for (TextureSlot& slot : Slots)
 	{
-		p.second.Release();
-		assert(p.second.RefCount == 0);
+		if (slot.Data)
+		{
+			slot.Data->Release();
+			assert(slot.Data->RefCount == 0);
+			delete slot.Data;
+		}
 	}
 
-	Textures.clear();
+	Slots.clear();
+	FreeSlots.clear();
+	HandlesByName.clear();
 }
 
 void TextureMgr::Init()
 {
 	gData.DebugMgr->RegisterDebugableWindow("TextureMgr", this);
+	StartWorkers();
 }
 
 void TextureMgr::Shut()
 {
+	StopAndJoinWorkers();
 	gData.DebugMgr->UnregisterDebugableWindow("TextureMgr");
 }
 
 bool TextureMgr::LoadTexture(const std::filesystem::path& path)
 {
-	if (!std::filesystem::exists(path.native()))
+	MemoryTagScope scope(eMemoryTag::Textures);
+
+	bool created = false;
+	const TextureHandle handle = CreateTexture(path.string(), created);
+	if (!created && !RetryFailedTexture(handle))
 	{
-		std::cerr << "Texture file doesn't exist " << path << std::endl;
+		std::cerr << "LoadTexture: " << path << " is already loaded" << std::endl;
 		return false;
 	}
 
-	std::filesystem::path metadataPath = path;
-	metadataPath = metadataPath.replace_extension(".xml");
-	if (!std::filesystem::exists(metadataPath.native()))
+	TextureLoadJob job;
+	job.Handle = handle;
+	job.Path = path;
+	job.Decoded = DecodeTexture(job);
+
+	return FinalizeTexture(job);
+}
+
+TextureHandle TextureMgr::LoadTextureAsync(const std::filesystem::path& path)
+{
+	MemoryTagScope scope(eMemoryTag::Textures);
+
+	bool created = false;
+	const TextureHandle handle = CreateTexture(path.string(), created);
+	if (!created && !RetryFailedTexture(handle))
 	{
-		std::cerr << "Texture metadata file doesn't exist " << metadataPath << std::endl;
-		return false;
+		// Already loaded or queued
+		return handle;
 	}
 
-	auto p = Textures.emplace(std::piecewise_construct, 
-				std::forward_as_tuple(path.string()),
-				std::forward_as_tuple());
+	TextureLoadJob* job = new TextureLoadJob();
+	job->Handle = handle;
+	job->Path = path;
 
-	if (!p.second)
+	++PendingLoadCount;
+
+	if (Workers.empty())
 	{
-		std::cerr << "LoadTexture: Internal error. Cannot emplace in map" << std::endl;
-		return false;
+		// No worker (not initialized or already shut): decode now, the upload still waits for Update
+		job->Decoded = DecodeTexture(*job);
+		DecodedJobs.push_back(job);
+		return handle;
 	}
-	
-	TextureData& textureData = p.first->second;
-	textureData.AddRef();
-	if (!textureData.Texture.loadFromFile(path.string()))
+
+	{
+		std::lock_guard<std::mutex> lock(JobsMutex);
+		QueuedJobs.push_back(job);
+	}
+	JobsCondition.notify_one();
+
+	return handle;
+}
+
+bool TextureMgr::UnloadTexture(TextureHandle handle)
+{
+	if (!IsAlive(handle))
 	{
 		return false;
 	}
-	
-	if (!LoadTextureMetadata(metadataPath, textureData))
+
+	TextureSlot& slot = Slots[handle.Index];
+	if (slot.Data->RefCount > 1 || slot.Data->State == eTextureState::Loading)
 	{
+		std::cerr << "UnloadTexture: " << slot.Name << " is still used" << std::endl;
 		return false;
 	}
 
+	// The atlas keeps the pixels: pages are never repacked
+	slot.Data->Release();
+	delete slot.Data;
+	slot.Data = nullptr;
+
+	HandlesByName.erase(slot.Name);
+	slot.Name.clear();
+	++slot.Generation;
+
+	FreeSlots.push_back(handle.Index);
 	return true;
 }
 
-const TextureData& TextureMgr::GetTextureData(const std::string& name) const
+TextureHandle TextureMgr::CreateTexture(const std::string& name, bool& created)
 {
-	assert(Textures.find(name) != Textures.end());
-	return Textures.at(name);
-}
+	const auto& it = HandlesByName.find(name);
+	if (it != HandlesByName.end())
+	{
+		created = false;
+		return it->second;
+	}
 
-sf::Texture emptyTexture;
+	TextureHandle handle;
+	if (!FreeSlots.empty())
+	{
+		handle.Index = FreeSlots.back();
+		FreeSlots.pop_back();
+	}
+	else
+	{
+		handle.Index = (uint32_t)Slots.size();
+		Slots.push_back(TextureSlot{ nullptr, std::string(), 0 });
+	}
 
-const sf::Texture& TextureMgr::GetEmptyTexture()
-{
-	return emptyTexture;
+	TextureSlot& slot = Slots[handle.Index];
+	slot.Data = new TextureData();
+	slot.Name = name;
+	handle.Generation = slot.Generation;
+
+	// The manager keeps its own reference until the texture is unloaded
+	slot.Data->AddRef();
+
+	HandlesByName.emplace(name, handle);
+	created = true;
+	return handle;
 }
 
-const sf::Texture& TextureMgr::GetMissingTexture()
+bool TextureMgr::RetryFailedTexture(TextureHandle handle)
 {
-	return emptyTexture;
+	// The slot and its handle are kept: users of the failed texture pick it up once it is ready
+	TextureData& textureData = *Slots[handle.Index].Data;
+	if (textureData.State != eTextureState::Failed)
+	{
+		return false;
+	}
+
+	textureData.State = eTextureState::Loading;
+	return true;
 }
 
-bool TextureMgr::LoadTextureMetadata(const std::filesystem::path& path, TextureData& textureData)
+void TextureMgr::Update()
 {
-	rapidxml::file<> metadataFile(path.string().c_str());
-	if (metadataFile.size() == 0)
+	if (PendingLoadCount == 0)
 	{
-		std::cerr << "LoadTextureMetadata: Cannot open file " << path << std::endl;
-		return false;
+		return;
 	}
 
-	rapidxml::xml_document metadataXml;
-	metadataXml.parse<0>(metadataFile.data());
+	std::vector<TextureLoadJob*> decodedJobs;
+	{
+		std::lock_guard<std::mutex> lock(JobsMutex);
+		decodedJobs.swap(DecodedJobs);
+	}
 
-	if (rapidxml::xml_node<>* node = metadataXml.first_node("Animations"))
+	// Always upload at least one texture so that a big one can't stall the queue
+	sf::Clock clock;
+	size_t finalized = 0;
+	for (; finalized < decodedJobs.size(); ++finalized)
 	{
-		if (!LoadAnimationMetadata(node, textureData))
+		if (finalized > 0 && clock.getElapsedTime().asSeconds() * 1000.f >= FinalizeBudgetInMs)
 		{
-			return false;
+			break;
 		}
+
+		FinalizeTexture(*decodedJobs[finalized]);
+		delete decodedJobs[finalized];
+		--PendingLoadCount;
 	}
 
-	if (rapidxml::xml_node<>* node = metadataXml.first_node("Backgrounds"))
+	if (finalized < decodedJobs.size())
 	{
-		if (!LoadStaticTileMetadata(node, textureData))
-		{
-			return false;
-		}
+		std::lock_guard<std::mutex> lock(JobsMutex);
+		DecodedJobs.insert(DecodedJobs.begin(), decodedJobs.begin() + finalized, decodedJobs.end());
 	}
+}
 
-	return true;
+size_t TextureMgr::GetPendingLoadCount() const
+{
+	return PendingLoadCount;
 }
 
-bool TextureMgr::LoadAnimationMetadata(rapidxml::xml_node<>* node, TextureData& textureData)
+void TextureMgr::StartWorkers()
 {
-	if (!node)
+	if (!Workers.empty())
 	{
-		return false;
+		return;
 	}
 
-	rapidxml::xml_node<>* animationNode = node->first_node();
-	while (animationNode)
+	// Keep a core for the main thread
+	const unsigned int coreCount = std::thread::hardware_concurrency();
+	const unsigned int workerCount = std::clamp(coreCount > 1 ? coreCount - 1 : 1u, 1u, MaxWorkerCount);
+
+	StopWorkers = false;
+	for (unsigned int i = 0; i < workerCount; ++i)
 	{
-		rapidxml::xml_attribute<>* nameAttribute = animationNode->first_attribute("Name");
-		if (nameAttribute)
-		{
-			auto p = textureData.AnimationsData.emplace(std::string(nameAttribute->value(), nameAttribute->value_size()), AnimationData());
-			if (p.second)
-			{
-				AnimationData& data = p.first->second;
-				if (rapidxml::xml_node<>* innerNode = animationNode->first_node("X"))
-				{
-					std::string value(innerNode->value(), innerNode->value_size());
-					data.StartX = atoi(value.c_str());
-				}
+		Workers.emplace_back(&TextureMgr::WorkerLoop, this);
+	}
+}
 
-				if (rapidxml::xml_node<>* innerNode = animationNode->first_node("Y"))
-				{
-					std::string value(innerNode->value(), innerNode->value_size());
-					data.StartY = atoi(value.c_str());
-				}
+void TextureMgr::StopAndJoinWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(JobsMutex);
+		StopWorkers = true;
+	}
+	JobsCondition.notify_all();
 
-				if (rapidxml::xml_node<>* innerNode = animationNode->first_node("SizeX"))
-				{
-					std::string value(innerNode->value(), innerNode->value_size());
-					data.SizeX = atoi(value.c_str());
-				}
+	for (std::thread& worker : Workers)
+	{
+		worker.join();
+	}
+	Workers.clear();
 
-				if (rapidxml::xml_node<>* innerNode = animationNode->first_node("SizeY"))
-				{
-					std::string value(innerNode->value(), innerNode->value_size());
-					data.SizeY = atoi(value.c_str());
-				}
+	// Loads still queued are dropped: their textures fail, so they can be unloaded or loaded again
+	for (TextureLoadJob* job : QueuedJobs)
+	{
+		DropJob(job);
+	}
+	QueuedJobs.clear();
 
-				if (rapidxml::xml_node<>* innerNode = animationNode->first_node("OffsetX"))
-				{
-					std::string value(innerNode->value(), innerNode->value_size());
-					data.OffsetX = atoi(value.c_str());
-				}
+	for (TextureLoadJob* job : DecodedJobs)
+	{
+		DropJob(job);
+	}
+	DecodedJobs.clear();
 
-				if (rapidxml::xml_node<>* innerNode = animationNode->first_node("OffsetY"))
-				{
-					std::string value(innerNode->value(), innerNode->value_size());
-					data.OffsetY = atoi(value.c_str());
-				}
-				
-				if (rapidxml::xml_node<>* innerNode = animationNode->first_node("SpriteNum"))
-				{
-					std::string value(innerNode->value(), innerNode->value_size());
-					data.AnimationSpriteCount = atoi(value.c_str());
-				}
+	PendingLoadCount = 0;
+}
 
-				if (rapidxml::xml_node<>* innerNode = animationNode->first_node("SpritesOnLine"))
-				{
-					std::string value(innerNode->value(), innerNode->value_size());
-					data.SpriteOnLine = atoi(value.c_str());
-				}
+void TextureMgr::DropJob(TextureLoadJob* job)
+{
+	if (IsAlive(job->Handle))
+	{
+		Slots[job->Handle.Index].Data->State = eTextureState::Failed;
+	}
 
-				if (rapidxml::xml_node<>* innerNode = animationNode->first_node("Reverted"))
-				{
-					std::string value(innerNode->value(), innerNode->value_size());
-					data.IsReverted = atoi(value.c_str());
-				}
+	delete job;
+}
 
-				if (rapidxml::xml_node<>* innerNode = animationNode->first_node("TimeBetweenAnimation"))
-				{
-					std::string value(innerNode->value(), innerNode->value_size());
-					data.TimeBetweenAnimationInS = std::stof(value.c_str());
-				}
-			}
-			else
+void TextureMgr::WorkerLoop()
+{
+	PROFILER_THREAD_NAME("Texture loader");
+
+	while (true)
+	{
+		TextureLoadJob* job = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(JobsMutex);
+			JobsCondition.wait(lock, [this]() { return StopWorkers || !QueuedJobs.empty(); });
+
+			if (StopWorkers)
 			{
-				std::cerr << "LoadAnimationMetadata: Cannot add animation " << nameAttribute->value() << ". Ignore it" << std::endl;
+				return;
 			}
+
+			job = QueuedJobs.front();
+			QueuedJobs.pop_front();
 		}
-		else
-		{
-			std::cerr << "LoadAnimationMetadata: Find a animation node with no name. Ignore it" << std::endl;
-		}
 
-		animationNode = animationNode->next_sibling();
+		MemoryTagScope scope(eMemoryTag::Textures);
+
+		PROFILER_EVENT_BEGIN(PROFILER_COLOR_BLUE, "Decode texture");
+		job->Decoded = DecodeTexture(*job);
+		PROFILER_EVENT_END();
+
+		std::lock_guard<std::mutex> lock(JobsMutex);
+		DecodedJobs.push_back(job);
 	}
+}
 
-	return true;
+// Runs on the workers: must only read the pack and the disk, and write in the job
+bool TextureMgr::DecodeTexture(TextureLoadJob& job) const
+{
+	AssetPack::AssetView packedImage;
+	const bool isPacked = gData.AssetPack->Find(job.Path, packedImage);
+
+	if (!isPacked && !std::filesystem::exists(job.Path.native()))
+	{
+		std::cerr << "Texture file doesn't exist " << job.Path << std::endl;
+		return false;
+	}
+
+	if (isPacked ? !job.Image.loadFromMemory(packedImage.Data, packedImage.Size) : !job.Image.loadFromFile(job.Path.string()))
+	{
+		return false;
+	}
+
+	MemoryTagScope scope(eMemoryTag::Animations);
+	return LoadTextureMetadata(job.Path, job.AnimationsData, job.StaticTilesData);
 }
 
-bool TextureMgr::LoadStaticTileMetadata(rapidxml::xml_node<>* node, TextureData& textureData)
+bool TextureMgr::FinalizeTexture(TextureLoadJob& job)
 {
-	if (!node)
+	MemoryTagScope scope(eMemoryTag::Textures);
+
+	if (!IsAlive(job.Handle))
+	{
+		return false;
+	}
+
+	TextureData& textureData = *Slots[job.Handle.Index].Data;
+	textureData.State = eTextureState::Failed;
+
+	if (!job.Decoded)
 	{
+		std::cerr << "LoadTexture: Cannot load " << job.Path << std::endl;
 		return false;
 	}
 
-	rapidxml::xml_node<>* tileNode = node->first_node();
-	while (tileNode)
+	TextureAtlas::Region region;
+	if (!Atlas.Insert(job.Image, region))
+	{
+		std::cerr << "LoadTexture: Cannot insert " << job.Path << " in the texture atlas" << std::endl;
+		return false;
+	}
+
+	textureData.Texture = region.Page;
+	textureData.AtlasPosition = region.Position;
+	textureData.Size = region.Size;
+	BuildAnimationTable(textureData, job.AnimationsData);
+	textureData.StaticTilesData = std::move(job.StaticTilesData);
+
+	MoveMetadataToAtlas(textureData);
+
+	textureData.State = eTextureState::Ready;
+	return true;
+}
+
+TextureHandle TextureMgr::FindTexture(const std::string& name) const
+{
+	const auto& it = HandlesByName.find(name);
+	return it != HandlesByName.end() ? it->second : TextureHandle();
+}
+
+bool TextureMgr::IsAlive(TextureHandle handle) const
+{
+	return handle.Index < Slots.size() && Slots[handle.Index].Generation == handle.Generation && Slots[handle.Index].Data;
+}
+
+const TextureData& TextureMgr::GetTextureData(TextureHandle handle) const
+{
+	assert(IsAlive(handle));
+	return *Slots[handle.Index].Data;
+}
+
+const TextureData& TextureMgr::GetTextureData(const std::string& name) const
+{
+	return GetTextureData(FindTexture(name));
+}
+
+sf::Texture emptyTexture;
+
+const sf::Texture& TextureMgr::GetEmptyTexture()
+{
+	return emptyTexture;
+}
+
+// Magenta checker, created on first use
+const sf::Texture& TextureMgr::GetMissingTexture()
+{
+	static const sf::Texture missingTexture = []()
 	{
-		rapidxml::xml_attribute<>* nameAttribute = tileNode->first_attribute("Name");
-		if (nameAttribute)
+		const unsigned int size = 16;
+		sf::Image image(sf::Vector2u(size, size), sf::Color::Magenta);
+		for (unsigned int y = 0; y < size; ++y)
 		{
-			auto p = textureData.StaticTilesData.emplace(std::string(nameAttribute->value(), nameAttribute->value_size()), StaticTileData());
-			if (p.second)
+			for (unsigned int x = 0; x < size; ++x)
 			{
-				StaticTileData& data = p.first->second;
-				if (rapidxml::xml_node<>* innerNode = tileNode->first_node("X"))
+				if ((x / (size / 2) + y / (size / 2)) % 2)
 				{
-					std::string value(innerNode->value(), innerNode->value_size());
-					data.StartX = atoi(value.c_str());
+					image.setPixel(sf::Vector2u(x, y), sf::Color::Black);
 				}
+			}
+		}
 
-				if (rapidxml::xml_node<>* innerNode = tileNode->first_node("Y"))
-				{
-					std::string value(innerNode->value(), innerNode->value_size());
-					data.StartY = atoi(value.c_str());
-				}
+		sf::Texture texture;
+		if (!texture.loadFromImage(image))
+		{
+			std::cerr << "GetMissingTexture: Cannot create the texture" << std::endl;
+		}
+		return texture;
+	}();
 
-				if (rapidxml::xml_node<>* innerNode = tileNode->first_node("SizeX"))
-				{
-					std::string value(innerNode->value(), innerNode->value_size());
-					data.SizeX = atoi(value.c_str());
-				}
+	return missingTexture;
+}
 
-				if (rapidxml::xml_node<>* innerNode = tileNode->first_node("SizeY"))
-				{
-					std::string value(innerNode->value(), innerNode->value_size());
-					data.SizeY = atoi(value.c_str());
-				}
+// Prefers the cooked metadata from the pack, then from disk unless the xml was modified since the last cook
+bool TextureMgr::LoadTextureMetadata(const std::filesystem::path& path, AnimationDataMap& animations, StaticTileDataMap& staticTiles) const
+{
+	std::filesystem::path xmlPath = path;
+	xmlPath.replace_extension(".xml");
 
-				if (rapidxml::xml_node<>* innerNode = tileNode->first_node("RevertedX"))
-				{
-					std::string value(innerNode->value(), innerNode->value_size());
-					data.IsRevertedX = atoi(value.c_str());
-				}
+	std::filesystem::path cookedPath = path;
+	cookedPath.replace_extension(TextureMetadata::CookedExtension);
 
-				if (rapidxml::xml_node<>* innerNode = tileNode->first_node("RevertedY"))
-				{
-					std::string value(innerNode->value(), innerNode->value_size());
-					data.IsRevertedY = atoi(value.c_str());
-				}
-			}
-			else
+	AssetPack::AssetView packedMetadata;
+	if (gData.AssetPack->Find(cookedPath, packedMetadata))
+	{
+		return TextureMetadata::LoadCooked(packedMetadata.Data, packedMetadata.Size, animations, staticTiles);
+	}
+
+	std::error_code error;
+	const bool hasXml = std::filesystem::exists(xmlPath, error);
+	if (std::filesystem::exists(cookedPath, error))
+	{
+		if (!hasXml || std::filesystem::last_write_time(cookedPath, error) >= std::filesystem::last_write_time(xmlPath, error))
+		{
+			if (TextureMetadata::LoadCooked(cookedPath, animations, staticTiles))
 			{
-				std::cerr << "LoadStaticTileMetadata: Cannot add static Data " << nameAttribute->value() << ". Ignore it" << std::endl;
+				return true;
 			}
+
+			animations.clear();
+			staticTiles.clear();
 		}
 		else
 		{
-			std::cerr << "LoadStaticTileMetadata: Find a tile node with no name. Ignore it" << std::endl;
+			std::cerr << "LoadTextureMetadata: " << cookedPath << " is older than its xml, run the AssetCooker again" << std::endl;
 		}
+	}
 
-		tileNode = tileNode->next_sibling();
+	if (!hasXml)
+	{
+		std::cerr << "Texture metadata file doesn't exist " << xmlPath << std::endl;
+		return false;
 	}
 
-	return true;
+	return TextureMetadata::LoadFromXml(xmlPath, animations, staticTiles);
+}
+
+void TextureMgr::BuildAnimationTable(TextureData& textureData, AnimationDataMap& animations)
+{
+	MemoryTagScope scope(eMemoryTag::Animations);
+
+	std::vector<const std::string*> names;
+	names.reserve(animations.size());
+	for (const auto& [name, data] : animations)
+	{
+		names.push_back(&name);
+	}
+
+	// Sorted so that ids don't depend on the hash map order
+	std::sort(names.begin(), names.end(), [](const std::string* a, const std::string* b)
+	{
+		return *a < *b;
+	});
+
+	textureData.Animations.clear();
+	textureData.Animations.reserve(names.size());
+	textureData.AnimationIdsByName.clear();
+	textureData.AnimationIdsByName.reserve(names.size());
+
+	for (const std::string* name : names)
+	{
+		AnimationId animation;
+		animation.Index = (uint32_t)textureData.Animations.size();
+
+		textureData.Animations.push_back(animations.at(*name));
+		textureData.AnimationIdsByName.emplace(*name, animation);
+	}
+}
+
+void TextureMgr::MoveMetadataToAtlas(TextureData& textureData)
+{
+	const int offsetX = (int)textureData.AtlasPosition.x;
+	const int offsetY = (int)textureData.AtlasPosition.y;
+
+	for (AnimationData& data : textureData.Animations)
+	{
+		data.StartX += offsetX;
+		data.StartY += offsetY;
+	}
+
+	for (auto& [name, data] : textureData.StaticTilesData)
+	{
+		data.StartX += offsetX;
+		data.StartY += offsetY;
+	}
 }
 
 void TextureMgr::DrawDebug()
 {
 #ifdef _USE_IMGUI
 
+	ImGui::Text("Pending loads: %d", (int)PendingLoadCount);
+
 	const auto flags = ImGuiTableFlags_Resizable | ImGuiTableFlags_NoSavedSettings | ImGuiTableFlags_Borders;
 
 	if (ImGui::BeginTable("##Textures", 5, flags))
@@ -303,8 +538,16 @@ void TextureMgr::DrawDebug()
 		ImGui::TableSetupColumn("Image");
 		ImGui::TableHeadersRow();
 
-		for (const auto& [name, data] : Textures)
+		for (const TextureSlot& slot : Slots)
 		{
+			if (!slot.Data)
+			{
+				continue;
+			}
+
+			const std::string& name = slot.Name;
+			const TextureData& data = *slot.Data;
+
 			int count = data.RefCount;
 
 			ImVec4 color = count > 1 ? ImVec4(255, 255, 255, 255) : ImVec4(200, 0, 0, 255);
@@ -312,15 +555,26 @@ void TextureMgr::DrawDebug()
 
 			ImGui::TableNextColumn();
 			ImGui::TextWrapped(name.c_str());
+			if (!data.IsReady())
+			{
+				ImGui::TextWrapped(data.State == eTextureState::Loading ? "Loading..." : "Failed");
+			}
 			ImGui::TableNextColumn();
-			ImGui::TextWrapped("%d", data.Texture.getSize().x);
+			ImGui::TextWrapped("%d", data.Size.x);
 			ImGui::TableNextColumn();
-			ImGui::TextWrapped("%d", data.Texture.getSize().y);
+			ImGui::TextWrapped("%d", data.Size.y);
 			ImGui::TableNextColumn();
 			ImGui::TextWrapped("%d", count);
 			ImGui::TableNextColumn();
 
-			const sf::Vector2f size((float)data.Texture.getSize().x, (float) data.Texture.getSize().y);
+			if (!data.Texture)
+			{
+				ImGui::PopStyleColor();
+				ImGui::TableNextRow();
+				continue;
+			}
+
+			const sf::Vector2f size((float)data.Size.x, (float) data.Size.y);
 			const float displayMaxSizeX = 200;
 			const float displayMaxSizeY = 200;
 
@@ -340,7 +594,8 @@ void TextureMgr::DrawDebug()
 				displaySize.y = displayMaxSizeY;
 			}
 
-			ImGui::Image(data.Texture, displaySize);
+			const sf::Sprite region(*data.Texture, sf::IntRect(sf::Vector2i(data.AtlasPosition), sf::Vector2i(data.Size)));
+			ImGui::Image(region, displaySize);
 
 			ImGui::PopStyleColor();
 
@@ -349,19 +604,42 @@ void TextureMgr::DrawDebug()
 		ImGui::EndTable();
 	}
 
+	if (ImGui::CollapsingHeader("Atlas pages"))
+	{
+		for (size_t i = 0; i < Atlas.GetPageCount(); ++i)
+		{
+			const sf::Texture& page = Atlas.GetPage(i);
+			ImGui::Text("Page %d: %dx%d, %.1f%% used", (int)i, page.getSize().x, page.getSize().y, Atlas.GetPageOccupancy(i) * 100.f);
+			ImGui::Image(page, sf::Vector2f(256.f, 256.f * (float)page.getSize().y / (float)page.getSize().x));
+		}
+	}
+
 #endif
 }
 
-AnimationData::AnimationData(): StartX(0), StartY(0), SizeX(0), SizeY(0),
-OffsetX(0), OffsetY(0), AnimationSpriteCount(0), SpriteOnLine(0), IsReverted(false)
-{}
-
-TextureData::TextureData(): Texture(), AnimationsData(), RefCount(0)
+TextureData::TextureData(): State(eTextureState::Loading), Texture(nullptr), AtlasPosition(), Size(), Animations(), RefCount(0)
 {}
 
 TextureData::~TextureData()
 {
-	AnimationsData.clear();
+	Animations.clear();
+}
+
+bool TextureData::IsReady() const
+{
+	return State == eTextureState::Ready;
+}
+
+AnimationId TextureData::FindAnimation(const std::string& name) const
+{
+	const auto& it = AnimationIdsByName.find(name);
+	return it != AnimationIdsByName.end() ? it->second : AnimationId();
+}
+
+const AnimationData& TextureData::GetAnimation(AnimationId animation) const
+{
+	assert(animation.Index < Animations.size());
+	return Animations[animation.Index];
 }
 
 void TextureData::AddRef() const
@@ -1,39 +1,38 @@
 #pragma once
 
 #include <Engine/Debug/DebugMgr.h>
+#include <Engine/Render/Ressource/TextureAtlas.h>
+#include <Engine/Render/Ressource/TextureMetadata.h>
+#include <Engine/Render/Ressource/TextureHandle.h>
 
 #include <SFML/Graphics/Texture.hpp>
-#include <rapidxml/rapidxml.hpp>
 
 #include <unordered_map>
 #include <filesystem>
 #include <string>
 #include <atomic>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
-struct AnimationData
+enum class eTextureState
 {
-	AnimationData();
-
-	int StartX;
-	int StartY;
-	int SizeX;
-	int SizeY;
-	int OffsetX;
-	int OffsetY;
-	int AnimationSpriteCount;
-	int SpriteOnLine;
-	bool IsReverted;
-	float TimeBetweenAnimationInS;
+	Loading,
+	Ready,
+	Failed
 };
 
-struct StaticTileData
+// Index of an animation in the table of its texture. Resolve it once by name, then switching animation is a single store
+struct AnimationId
 {
-	int StartX;
-	int StartY;
-	int SizeX;
-	int SizeY;
-	bool IsRevertedX;
-	bool IsRevertedY;
+	static constexpr uint32_t InvalidIndex = 0xFFFFFFFF;
+
+	uint32_t Index = InvalidIndex;
+
+	bool IsValid() const { return Index != InvalidIndex; }
+	bool operator==(const AnimationId& other) const = default;
 };
 
 struct TextureData
@@ -41,9 +40,20 @@ struct TextureData
 	TextureData();
 	~TextureData();
 
-	sf::Texture Texture;
-	std::unordered_map<std::string, AnimationData> AnimationsData;
-	std::unordered_map<std::string, StaticTileData> StaticTilesData;
+	eTextureState State;
+	bool IsReady() const;
+
+	// Atlas page holding the image. Animations and tiles coordinates are already in page space
+	const sf::Texture* Texture;
+	sf::Vector2u AtlasPosition;
+	sf::Vector2u Size;
+
+	// Sorted by name, built once the texture is loaded
+	std::vector<AnimationData> Animations;
+	StaticTileDataMap StaticTilesData;
+
+	AnimationId FindAnimation(const std::string& name) const;
+	const AnimationData& GetAnimation(AnimationId animation) const;
 
 	void AddRef() const;
 	void Release() const;
@@ -51,6 +61,7 @@ struct TextureData
 	friend class TextureMgr;
 private:
 	mutable std::atomic<int> RefCount;
+	std::unordered_map<std::string, AnimationId> AnimationIdsByName;
 };
 
 class TextureMgr final : public IDebugable
@@ -65,6 +76,22 @@ public:
 
 	bool LoadTexture(const std::filesystem::path& path);
 
+	// Decodes the image and its metadata on a worker thread. The texture stays Loading until Update uploads it.
+	// Loading a Failed texture again retries it with the same handle
+	TextureHandle LoadTextureAsync(const std::filesystem::path& path);
+
+	// Frees the slot once nothing but the manager references the texture. Handles on it become stale
+	bool UnloadTexture(TextureHandle handle);
+
+	// Uploads the textures decoded by the workers, for at most FinalizeBudgetInMs per frame
+	void Update();
+	size_t GetPendingLoadCount() const;
+
+	// Resolve the name once, then keep the handle
+	TextureHandle FindTexture(const std::string& name) const;
+	bool IsAlive(TextureHandle handle) const;
+
+	const TextureData& GetTextureData(TextureHandle handle) const;
 	const TextureData& GetTextureData(const std::string& name) const;
 
 	static const sf::Texture& GetEmptyTexture();
@@ -73,9 +100,54 @@ public:
 	virtual void DrawDebug() override;
 
 private:
-	std::unordered_map<std::string, TextureData> Textures;
-
-	bool LoadTextureMetadata(const std::filesystem::path& path, TextureData& textureData);
-	bool LoadAnimationMetadata(rapidxml::xml_node<>* node, TextureData& textureData);
-	bool LoadStaticTileMetadata(rapidxml::xml_node<>* node, TextureData& textureData);
+	struct TextureSlot
+	{
+		TextureData* Data;
+		std::string Name;
+		uint32_t Generation;
+	};
+
+	// Textures are allocated once so that references on their data stay valid, slots are recycled through FreeSlots
+	std::vector<TextureSlot> Slots;
+	std::vector<uint32_t> FreeSlots;
+	std::unordered_map<std::string, TextureHandle> HandlesByName;
+	TextureAtlas Atlas;
+
+	TextureHandle CreateTexture(const std::string& name, bool& created);
+
+	// Everything a worker produces. Only the main thread touches Textures and the atlas
+	struct TextureLoadJob
+	{
+		TextureHandle Handle;
+		std::filesystem::path Path;
+		sf::Image Image;
+		AnimationDataMap AnimationsData;
+		StaticTileDataMap StaticTilesData;
+		bool Decoded = false;
+	};
+
+	std::vector<std::thread> Workers;
+	std::mutex JobsMutex;
+	std::condition_variable JobsCondition;
+	std::deque<TextureLoadJob*> QueuedJobs;
+	std::vector<TextureLoadJob*> DecodedJobs;
+	size_t PendingLoadCount;
+	bool StopWorkers;
+
+	static constexpr unsigned int MaxWorkerCount = 4;
+	static constexpr float FinalizeBudgetInMs = 2.f;
+
+	bool RetryFailedTexture(TextureHandle handle);
+
+	void StartWorkers();
+	void StopAndJoinWorkers();
+	void WorkerLoop();
+	void DropJob(TextureLoadJob* job);
+
+	bool DecodeTexture(TextureLoadJob& job) const;
+	bool FinalizeTexture(TextureLoadJob& job);
+
+	bool LoadTextureMetadata(const std::filesystem::path& path, AnimationDataMap& animations, StaticTileDataMap& staticTiles) const;
+	void BuildAnimationTable(TextureData& textureData, AnimationDataMap& animations);
+	void MoveMetadataToAtlas(TextureData& textureData);
 };
\ No newline at end of file
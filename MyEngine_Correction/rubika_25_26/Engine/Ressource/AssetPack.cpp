@@ -0,0 +1,194 @@
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+AssetPack::AssetPack() : File(), MountPoint(), Entries(nullptr), EntryCount(0)
+{}
+
+AssetPack::~AssetPack()
+{
+	Unmount();
+}
+
+bool AssetPack::Mount(const std::filesystem::path& packPath, const std::filesystem::path& mountPoint)
+{
+	Unmount();
+
+	if (!File.Open(packPath))
+	{
+		return false;
+	}
+
+	PackHeader header;
+	if (File.GetSize() < sizeof(header))
+	{
+		std::cerr << "AssetPack: Truncated pack " << packPath << std::endl;
+		Unmount();
+		return false;
+	}
+
+	memcpy(&header, File.GetData(), sizeof(header));
+	if (header.Magic != PackMagic || header.Version != PackVersion)
+	{
+		std::cerr << "AssetPack: Unsupported pack " << packPath << ". Cook it again" << std::endl;
+		Unmount();
+		return false;
+	}
+
+	if (File.GetSize() < sizeof(PackHeader) + (size_t)header.EntryCount * sizeof(PackEntry))
+	{
+		std::cerr << "AssetPack: Corrupted pack " << packPath << std::endl;
+		Unmount();
+		return false;
+	}
+
+	// The mapping is page aligned and the header size is a multiple of 8: entries are read in place
+	Entries = reinterpret_cast<const PackEntry*>(File.GetData() + sizeof(PackHeader));
+	EntryCount = header.EntryCount;
+	MountPoint = mountPoint.lexically_normal();
+	return true;
+}
+
+void AssetPack::Unmount()
+{
+	File.Close();
+	Entries = nullptr;
+	EntryCount = 0;
+	MountPoint.clear();
+}
+
+bool AssetPack::IsMounted() const
+{
+	return File.IsOpen();
+}
+
+bool AssetPack::Find(const std::filesystem::path& assetPath, AssetView& view) const
+{
+	if (!IsMounted())
+	{
+		return false;
+	}
+
+	const std::filesystem::path relativePath = assetPath.lexically_normal().lexically_relative(MountPoint);
+	if (relativePath.empty() || *relativePath.begin() == "..")
+	{
+		return false;
+	}
+
+	const uint64_t hash = HashPath(relativePath.generic_string());
+	const PackEntry* end = Entries + EntryCount;
+	const PackEntry* entry = std::lower_bound(Entries, end, hash, [](const PackEntry& e, uint64_t h)
+	{
+		return e.PathHash < h;
+	});
+
+	if (entry == end || entry->PathHash != hash)
+	{
+		return false;
+	}
+
+	if (entry->Offset + entry->Size > File.GetSize())
+	{
+		std::cerr << "AssetPack: Corrupted entry for " << assetPath << std::endl;
+		return false;
+	}
+
+	view.Data = File.GetData() + entry->Offset;
+	view.Size = (size_t)entry->Size;
+	return true;
+}
+
+size_t AssetPack::GetAssetCount() const
+{
+	return EntryCount;
+}
+
+bool AssetPack::Write(const std::filesystem::path& packPath, const std::vector<SourceAsset>& assets)
+{
+	std::vector<PackEntry> entries;
+	entries.reserve(assets.size());
+
+	std::vector<size_t> order(assets.size());
+	for (size_t i = 0; i < assets.size(); ++i)
+	{
+		entries.push_back(PackEntry{ HashPath(assets[i].RelativePath), 0, assets[i].Content.size() });
+		order[i] = i;
+	}
+
+	std::sort(order.begin(), order.end(), [&entries](size_t a, size_t b)
+	{
+		return entries[a].PathHash < entries[b].PathHash;
+	});
+
+	std::vector<PackEntry> sortedEntries;
+	sortedEntries.reserve(entries.size());
+
+	uint64_t offset = sizeof(PackHeader) + entries.size() * sizeof(PackEntry);
+	for (size_t i = 0; i < order.size(); ++i)
+	{
+		PackEntry entry = entries[order[i]];
+		if (i > 0 && sortedEntries.back().PathHash == entry.PathHash)
+		{
+			std::cerr << "AssetPack: Hash collision on " << assets[order[i]].RelativePath << std::endl;
+			return false;
+		}
+
+		offset = (offset + DataAlignment - 1) & ~(DataAlignment - 1);
+		entry.Offset = offset;
+		offset += entry.Size;
+		sortedEntries.push_back(entry);
+	}
+
+	std::ofstream file(packPath, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cerr << "AssetPack: Cannot open file " << packPath << std::endl;
+		return false;
+	}
+
+	PackHeader header;
+	header.Magic = PackMagic;
+	header.Version = PackVersion;
+	header.EntryCount = (uint32_t)sortedEntries.size();
+	header.Reserved = 0;
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(sortedEntries.data()), sortedEntries.size() * sizeof(PackEntry));
+
+	const char padding[DataAlignment] = {};
+	uint64_t position = sizeof(PackHeader) + sortedEntries.size() * sizeof(PackEntry);
+	for (size_t i = 0; i < order.size(); ++i)
+	{
+		file.write(padding, sortedEntries[i].Offset - position);
+
+		const std::vector<unsigned char>& content = assets[order[i]].Content;
+		file.write(reinterpret_cast<const char*>(content.data()), content.size());
+		position = sortedEntries[i].Offset + content.size();
+	}
+
+	return (bool)file;
+}
+
+uint64_t AssetPack::HashPath(std::string_view relativePath)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (char c : relativePath)
+	{
+		if (c == '\\')
+		{
+			c = '/';
+		}
+		else if (c >= 'A' && c <= 'Z')
+		{
+			c = c - 'A' + 'a';
+		}
+
+		hash ^= (unsigned char)c;
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
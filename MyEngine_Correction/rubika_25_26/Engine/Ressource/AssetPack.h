@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Engine/Ressource/MappedFile.h>
+
+#include <filesystem>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+// Single file holding every asset of a folder, mapped once in memory.
+// Assets are found by the hash of their path relative to the mount point and returned as views on the mapped bytes.
+// Shared by the engine and the AssetCooker tool: must not depend on anything else in the engine.
+class AssetPack
+{
+public:
+	AssetPack();
+	~AssetPack();
+
+	AssetPack(const AssetPack&) = delete;
+	AssetPack& operator=(const AssetPack&) = delete;
+
+	struct AssetView
+	{
+		const unsigned char* Data;
+		size_t Size;
+	};
+
+	// mountPoint is the folder the pack replaces, assets are requested with the same paths as on disk
+	bool Mount(const std::filesystem::path& packPath, const std::filesystem::path& mountPoint);
+	void Unmount();
+	bool IsMounted() const;
+
+	bool Find(const std::filesystem::path& assetPath, AssetView& view) const;
+	size_t GetAssetCount() const;
+
+	struct SourceAsset
+	{
+		std::string RelativePath;
+		std::vector<unsigned char> Content;
+	};
+
+	static bool Write(const std::filesystem::path& packPath, const std::vector<SourceAsset>& assets);
+
+	// FNV-1a on the relative path, with '/' separators and lower case letters
+	static uint64_t HashPath(std::string_view relativePath);
+
+	static constexpr const char* DefaultFileName = "Ressources.pak";
+
+private:
+	static constexpr uint32_t PackMagic = 0x4B415052; // "RPAK"
+	static constexpr uint32_t PackVersion = 1;
+	static constexpr uint64_t DataAlignment = 16;
+
+	// Layout: header, entries sorted by hash, then the asset bytes
+	struct PackHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t EntryCount;
+		uint32_t Reserved;
+	};
+
+	struct PackEntry
+	{
+		uint64_t PathHash;
+		uint64_t Offset;
+		uint64_t Size;
+	};
+
+	static_assert(sizeof(PackHeader) == 16, "Pack header layout changed, bump PackVersion");
+	static_assert(sizeof(PackEntry) == 24, "Pack entry layout changed, bump PackVersion");
+
+	MappedFile File;
+	std::filesystem::path MountPoint;
+	const PackEntry* Entries;
+	uint32_t EntryCount;
+};
@@ -0,0 +1,153 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <iostream>
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : Data(nullptr), Size(0), FileHandle(INVALID_HANDLE_VALUE), MappingHandle(nullptr)
+{}
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+	Close();
+
+	FileHandle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (FileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(FileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+
+	MappingHandle = CreateFileMappingW(FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!MappingHandle)
+	{
+		std::cerr << "MappedFile: Cannot map " << path << std::endl;
+		Close();
+		return false;
+	}
+
+	Data = static_cast<const unsigned char*>(MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (!Data)
+	{
+		std::cerr << "MappedFile: Cannot map " << path << std::endl;
+		Close();
+		return false;
+	}
+
+	Size = (size_t)fileSize.QuadPart;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (Data)
+	{
+		UnmapViewOfFile(Data);
+		Data = nullptr;
+	}
+
+	if (MappingHandle)
+	{
+		CloseHandle(MappingHandle);
+		MappingHandle = nullptr;
+	}
+
+	if (FileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(FileHandle);
+		FileHandle = INVALID_HANDLE_VALUE;
+	}
+
+	Size = 0;
+}
+
+#else
+
+MappedFile::MappedFile() : Data(nullptr), Size(0), FileDescriptor(-1)
+{}
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+	Close();
+
+	FileDescriptor = open(path.c_str(), O_RDONLY);
+	if (FileDescriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(FileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		Close();
+		return false;
+	}
+
+	void* data = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+	if (data == MAP_FAILED)
+	{
+		std::cerr << "MappedFile: Cannot map " << path << std::endl;
+		Close();
+		return false;
+	}
+
+	Data = static_cast<const unsigned char*>(data);
+	Size = (size_t)fileStat.st_size;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (Data)
+	{
+		munmap(const_cast<unsigned char*>(Data), Size);
+		Data = nullptr;
+	}
+
+	if (FileDescriptor >= 0)
+	{
+		close(FileDescriptor);
+		FileDescriptor = -1;
+	}
+
+	Size = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::IsOpen() const
+{
+	return Data != nullptr;
+}
+
+const unsigned char* MappedFile::GetData() const
+{
+	return Data;
+}
+
+size_t MappedFile::GetSize() const
+{
+	return Size;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <filesystem>
+
+// Read-only view of a whole file mapped in memory. The bytes stay valid until Close or destruction
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Open(const std::filesystem::path& path);
+	void Close();
+
+	bool IsOpen() const;
+	const unsigned char* GetData() const;
+	size_t GetSize() const;
+
+private:
+	const unsigned char* Data;
+	size_t Size;
+
+#ifdef _WIN32
+	void* FileHandle;
+	void* MappingHandle;
+#else
+	int FileDescriptor;
+#endif
+};
@@ -0,0 +1,7 @@
+#pragma once
+
+// SSE2 is always there on x64, and on x86 when the compiler is allowed to use it
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USE_SSE2
+#include <emmintrin.h>
+#endif
@@ -5,6 +5,8 @@
 #include <Engine/Console/LogConsole.h>
 #include <Engine/Globals.h>
 #include <Engine/Gameplay/GameMgr.h>
+#include <Engine/Profiler/CpuProfiler.h>
+#include <Engine/Memory/FrameArena.h>
 
 #include <Engine/Gameplay/Entity/Entity.h>
 #include <Engine/Gameplay/Component/Transform/Transform.h>
@@ -18,23 +20,24 @@
 
 #include <Engine/Profiler.h>
 
-Entity* CreateEntity()
+Entity* CreateEntity(TextureHandle isaacTexture)
 {
-    Entity* e = new Entity();
+    Entity* e = gData.GameMgr->CreateEntity("Isaac");
 
-    Transform* TransformComp = e->AddComponent<Transform>();
+    e->AddComponent<Transform>();
     Renderer* RendererComp = e->AddComponent<Renderer>();
 
     Sprite* Body = RendererComp->AddNewDrawable<Sprite>("Body", sf::Vector2f(2, 0), 0, sf::Vector2f(1, 1));
     Body->SetVisibility(true);
-    Body->SetTexture("../Ressources/IsaacSprite.png");
+    Body->SetTexture(isaacTexture);
     Body->SetAnimation("Body_Vertical");
 
     Sprite* Head = RendererComp->AddNewDrawable<Sprite>("Head", sf::Vector2f(-2.5f, -20), 0, sf::Vector2f(1, 1));
     Head->SetVisibility(true);
-    Head->SetTexture("../Ressources/IsaacSprite.png");
+    Head->SetTexture(isaacTexture);
     Head->SetAnimation("Head_Down");
 
+    Transform* TransformComp = e->GetComponent<Transform>();
     TransformComp->SetWorldPosition(sf::Vector2f(150.f, 150.f));
 
     return e;
@@ -53,41 +56,40 @@ int main()
     }
 #endif
 
-    if (!gData.TextureMgr->LoadTexture("../Ressources/IsaacSprite.png"))
+    // Decoded in the background, sprites show the missing texture until TextureMgr::Update uploads them
+    const char* startupTexturePaths[] =
     {
-        return -1;
-    }
-    
-    if (!gData.TextureMgr->LoadTexture("../Ressources/Basement.png"))
-    {
-        return -2;
-    }
-
-    if (!gData.TextureMgr->LoadTexture("../Ressources/Tear.png"))
+        "../Ressources/IsaacSprite.png",
+        "../Ressources/Basement.png",
+        "../Ressources/Tear.png",
+        "../Ressources/Rocks.png",
+        "../Ressources/Doors.png"
+    };
+
+    constexpr size_t startupTextureCount = sizeof(startupTexturePaths) / sizeof(startupTexturePaths[0]);
+    TextureHandle startupTextures[startupTextureCount];
+    for (size_t i = 0; i < startupTextureCount; ++i)
     {
-        return -2;
+        startupTextures[i] = gData.TextureMgr->LoadTextureAsync(startupTexturePaths[i]);
     }
 
-    if (!gData.TextureMgr->LoadTexture("../Ressources/Rocks.png"))
-    {
-        return -3;
-    }
+    const TextureHandle isaacTexture = startupTextures[0];
+    bool startupTexturesChecked = false;
 
-    if (!gData.TextureMgr->LoadTexture("../Ressources/Doors.png"))
-    {
-        return -4;
-    }
-
-    Entity* entity = CreateEntity();
+    Entity* entity = CreateEntity(isaacTexture);
 
     gData.GameMgr->AddEntity(entity);
+    gData.GameMgr->FlushCommands();
 
     sf::Clock clock;
     clock.restart();
 
     while (window.isOpen())
     {
-        PROFILER_EVENT_BEGIN(PROFILER_COLOR_BLACK, "Frame %llu", gData.FrameCount);
+        gData.Profiler->BeginFrame();
+        gData.FrameArena->BeginFrame();
+
+        PROFILER_EVENT_BEGIN(PROFILER_COLOR_BLACK, "Frame");
         {
             int deltaTimeMS = clock.getElapsedTime().asMilliseconds();
             float fDeltaTimeS = (float)deltaTimeMS / 1000.f;
@@ -116,6 +118,21 @@ int main()
                 ImGui::SFML::Update(window, imGuiTime);
 #endif
 
+                gData.TextureMgr->Update();
+
+                // Once the startup loads are over, report the textures that will only show as missing
+                if (!startupTexturesChecked && gData.TextureMgr->GetPendingLoadCount() == 0)
+                {
+                    for (size_t i = 0; i < startupTextureCount; ++i)
+                    {
+                        if (!gData.TextureMgr->GetTextureData(startupTextures[i]).IsReady())
+                        {
+                            Logger::Error(std::string("Cannot load the texture ") + startupTexturePaths[i]);
+                        }
+                    }
+                    startupTexturesChecked = true;
+                }
+
                 gData.GameMgr->Update(fDeltaTimeS);
             }
             PROFILER_EVENT_END();
@@ -145,6 +162,8 @@ int main()
             PROFILER_EVENT_END();
         }
         PROFILER_EVENT_END();
+
+        gData.Profiler->EndFrame();
         ++gData.FrameCount;
     }
 